@@ -0,0 +1,70 @@
+
+#
+# Project: vhdlstuff
+#
+# vhdlstuff is a vhdl parser/analyser
+#
+# Embed the sources of the standard vhdl libraries (std and ieee) into a C++
+# translation unit, so that these libraries are available without any file on
+# disk. Each input file must live in a directory named after its library and be
+# named after the primary unit it declares. Eg: stdlib/ieee/std_logic_1164.vhd
+#
+
+import argparse
+import os
+
+
+def to_array(name, data):
+    # the sources are ISO 8859-1. Bytes are written as character literals so
+    # that those above 0x7f do not narrow when char is signed
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join(f"'\\x{b:02x}'" for b in data[i:i + 16]) + ",")
+    lines.append("    '\\0'")
+    return f"const char {name}[] = {{\n" + "\n".join(lines) + "\n};\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description='embed standard vhdl libraries in vhdlstuff')
+    parser.add_argument('-o', '--output', required=True, help='output .cpp file')
+    parser.add_argument('files', metavar='FILE', type=str, nargs='+', help='vhdl source file(s)')
+    args = parser.parse_args()
+
+    arrays = []
+    entries = []
+    for i, path in enumerate(sorted(args.files)):
+        library = os.path.basename(os.path.dirname(path)).lower()
+        identifier = os.path.splitext(os.path.basename(path))[0].lower()
+        with open(path, "rb") as f:
+            data = f.read()
+
+        name = f"{library}_{identifier}"
+        arrays.append(to_array(name, data))
+        entries.append(f'    {{"{library}", "{identifier}", "{library}/{identifier}.vhd", '
+                       f'std::string_view({name}, {len(data)})}},')
+
+    output  = ['// generated by embed_stdlib.py. Do not edit', '']
+    output += ['#include "standard_libraries.h"', '']
+    output += ['namespace', '{', '']
+    output += arrays
+    output += ['}', '']
+    output += ['const vhdl::stdlib::embedded_file vhdl::stdlib::files[] = {']
+    output += entries
+    output += ['};', '']
+    output += [f'const std::size_t vhdl::stdlib::number_of_files = {len(entries)};', '']
+    output = "\n".join(output)
+
+    # only touch the output if it changed, to avoid needless rebuilds
+    try:
+        with open(args.output, "r") as f:
+            content = f.read()
+    except OSError:
+        content = ""
+
+    if content != output:
+        with open(args.output, "w") as f:
+            f.write(output)
+
+
+if __name__ == "__main__":
+    main()
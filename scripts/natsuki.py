@@ -1886,6 +1886,12 @@ class Nodes_Dot_H_Generator(Generator):
             result += [""]
             result += [ private.content.rstrip() ]
 
+        # the statically dispatched traverse methods are templates, so they
+        # have to live in the header
+        if 'visitable' in self.file.options:
+            result += [""]
+            result += Static_Traverse_Generator(self.file, self.name).generate()
+
         # almost done. if there was a custom namespace, close it
         if 'namespace' in self.file.options:
             result += ["}"]
@@ -2159,6 +2165,7 @@ class Nodes_Dot_H_Generator(Generator):
         if 'visitable' in self.file.options:
             result += [""]
             result += ["    void traverse(visitor& v);"]
+            result += ["    template <typename V> void traverse_static(V& v);"]
 
         # we are done
         result += ["};"]
@@ -2305,38 +2312,56 @@ class Nodes_Dot_Cpp_Generator(Generator):
 
         if 'visitable' in self.file.options:
             result += ["void {}::traverse(visitor& __v__)".format(node.name)]
-            result += ["{"]
+            result += self.generate_traverse_body(node)
 
-            # if has children, this is a parent node. Do not call the
-            # visitor.visit() function - this will already have been done by
-            # the child node
-            if node.children != []:
-                pass
-            else:
-                result += ["    if (!__v__.visit(this)) return;"]
+        return result
 
-            for field in node.fields:
-                # dont even bother to traverse a notvisitable field
-                if not field.is_visitable:
-                    continue
-                result += self.generate_traveller(field)
+    # name of the traverse method, and how the visitor is called. These are
+    # overriden by the statically dispatched traversal
+    traverse = "traverse"
+    visit = "__v__.visit"
+    post_visit = "__v__.post_visit"
 
-            # if has parents, this is a child node. Call the corresponding
-            # parent::traverse() functions
-            for parent in node.parents:
-                result += ["    {}::traverse(__v__);".format(parent)]
+    def generate_traverse_body(self, node):
+        result = []
+        result += ["{"]
 
-            # again, if has children, this is a parent node. Dont call the
-            # visitor.post_visit() function - this will already have been done
-            # by the child node
-            if node.children != []:
-                pass
-            else:
-                result += ["    __v__.post_visit(this);"]
+        # if has children, this is a parent node. Do not call the
+        # visitor.visit() function - this will already have been done by
+        # the child node
+        if node.children != []:
+            pass
+        else:
+            result += [f"    if (!{self.visit}(this)) return;"]
 
-            result += ["}"]
-            result += [""]
+        for field in node.fields:
+            # dont even bother to traverse a notvisitable field
+            if not field.is_visitable:
+                continue
+            result += self.generate_traveller(field)
+
+        # if has parents, this is a child node. Call the corresponding
+        # parent::traverse() functions
+        for parent in node.parents:
+            result += [f"    {parent}::{self.traverse}(__v__);"]
+
+        # again, if has children, this is a parent node. Dont call the
+        # visitor.post_visit() function - this will already have been done
+        # by the child node
+        if node.children != []:
+            pass
+        else:
+            result += [f"    {self.post_visit}(this);"]
 
+        result += ["}"]
+        result += [""]
+        return result
+
+    # dispatch to the child node. ptr is a pointer to an abstract node
+    def generate_dispatch(self, field, ptr, indent):
+        result = []
+        for child in field.resolved_type.children:
+            result += [f"{indent}if({ptr}->is_{child}()) {ptr}->as_{child}()->{self.traverse}(__v__);"]
         return result
 
     def generate_initialiser(self, field):
@@ -2577,50 +2602,46 @@ class Nodes_Dot_Cpp_Generator(Generator):
 
     def generate_traveller_node_pointer_value(self, field):
         if field.resolved_type.children == []:
-            return [f"    if ({field.name}) {field.name}->traverse(__v__);"]
+            return [f"    if ({field.name}) {field.name}->{self.traverse}(__v__);"]
 
         result = []
-        result += [f"    if ({field.name} && __v__.visit({field.name})) {{"]
-        for child in field.resolved_type.children:
-            result += [f"        if({field.name}->is_{child}()) {field.name}->as_{child}()->traverse(__v__);"]
+        result += [f"    if ({field.name} && {self.visit}({field.name})) {{"]
+        result += self.generate_dispatch(field, field.name, "        ")
         result += ["    }"]
 
         return result
 
     def generate_traveller_node_pointer_optional(self, field):
         if field.resolved_type.children == []:
-            return [f"    if ({field.name}) {field.name}->traverse(__v__);"]
+            return [f"    if ({field.name}) {field.name}->{self.traverse}(__v__);"]
 
         result = []
-        result += [f"    if ({field.name} && __v__.visit({field.name})) {{"]
-        for child in field.resolved_type.children:
-            result += [f"        if({field.name}->is_{child}()) {field.name}->as_{child}()->traverse(__v__);"]
+        result += [f"    if ({field.name} && {self.visit}({field.name})) {{"]
+        result += self.generate_dispatch(field, field.name, "        ")
         result += ["    }"]
 
         return result
 
     def generate_traveller_node_pointer_array(self, field):
         if field.resolved_type.children == []:
-            return [f"    for (auto& _it: {field.name}) if (_it) _it->traverse(__v__);"]
+            return [f"    for (auto& _it: {field.name}) if (_it) _it->{self.traverse}(__v__);"]
 
         result = []
         result += [f"    for (auto& _it: {field.name}) {{ if (!_it) continue;"]
-        result += ["        if (!__v__.visit(_it)) continue;"]
-        for child in field.resolved_type.children:
-            result += [f"        if(_it->is_{child}()) _it->as_{child}()->traverse(__v__);"]
+        result += [f"        if (!{self.visit}(_it)) continue;"]
+        result += self.generate_dispatch(field, "_it", "        ")
         result += ["    }"]
 
         return result
 
     def generate_traveller_node_pointer_map(self, field):
         if field.resolved_type.children == []:
-            return [f"    for (auto& _it: {field.name}) if (_it.second) _it.second->traverse(__v__);"]
+            return [f"    for (auto& _it: {field.name}) if (_it.second) _it.second->{self.traverse}(__v__);"]
 
         result = []
         result += [f"    for (auto& _it: {field.name}) {{ if (!_it.second) continue;"]
-        result += ["        if (!__v__.visit(_it.second)) continue;"]
-        for child in field.resolved_type.children:
-            result += [f"        if(_it.second->is_{child}()) _it.second->as_{child}()->traverse(__v__);"]
+        result += [f"        if (!{self.visit}(_it.second)) continue;"]
+        result += self.generate_dispatch(field, "_it.second", "        ")
         result += ["    }"]
 
         return result
@@ -2667,6 +2688,39 @@ class Nodes_Dot_Cpp_Generator(Generator):
                 result += [""]
         return result
 
+class Static_Traverse_Generator(Nodes_Dot_Cpp_Generator):
+    """
+    Generate traverse_static<V>(), the statically dispatched twin of
+    traverse(). The visitor is called with a qualified name, so there is no
+    virtual call per node and the compiler is free to inline the visit()
+    bodies of V. Abstract nodes are dispatched with a switch on their kind.
+
+    V must derive from visitor and must not hide any of its visit() or
+    post_visit() overloads (add `using visitor::visit;` when in doubt).
+    """
+
+    traverse = "traverse_static"
+    visit = "__v__.V::visit"
+    post_visit = "__v__.V::post_visit"
+
+    def generate(self):
+        result = []
+        for decl in self.file.declarations:
+            if isinstance(decl, Node):
+                result += ["template <typename V>"]
+                result += [f"void {decl.name}::traverse_static(V& __v__)"]
+                result += self.generate_traverse_body(decl)
+        return result
+
+    def generate_dispatch(self, field, ptr, indent):
+        result = []
+        result += [f"{indent}switch ({ptr}->get_kind()) {{"]
+        for child in field.resolved_type.children:
+            result += [f"{indent}case kind::{child}: static_cast<class {child}*>({ptr})->{self.traverse}(__v__); break;"]
+        result += [f"{indent}default: break;"]
+        result += [f"{indent}}}"]
+        return result
+
 def main():
     parser = argparse.ArgumentParser(description='generator of vhdl ast class for use in vhdlstuff')
     parser.add_argument('-o', '--output',                              help='output directory/file without .h or .cpp extension')
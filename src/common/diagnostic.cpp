@@ -41,3 +41,65 @@ common::diagnostic& common::diagnostic::operator<<(int arg)
     return *this;
 }
 
+
+void common::fingerprint_builder::mix(const void* data, std::size_t size)
+{
+    constexpr std::uint64_t fnv_prime = 1099511628211ull;
+
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= fnv_prime;
+    }
+}
+
+void common::fingerprint_builder::mix(std::uint64_t value)
+{
+    mix(&value, sizeof(value));
+}
+
+void common::fingerprint_builder::mix(std::string_view s)
+{
+    mix(s.size());
+    mix(s.data(), s.size());
+}
+
+
+namespace
+{
+
+void mix(common::fingerprint_builder& h, const common::diagnostic& d)
+{
+    h.mix(d.format);
+    h.mix(d.args.size());
+    for (auto& arg : d.args)
+    {
+        h.mix(arg.index());
+        if (std::holds_alternative<std::string>(arg))
+            h.mix(std::string_view(std::get<std::string>(arg)));
+        else
+            h.mix(static_cast<std::uint64_t>(std::get<int>(arg)));
+    }
+
+    h.mix(d.location.filename);
+    h.mix(d.location.begin.line);
+    h.mix(d.location.begin.column);
+    h.mix(d.location.end.line);
+    h.mix(d.location.end.column);
+
+    h.mix(d.notes.size());
+    for (auto& note : d.notes)
+        mix(h, note);
+}
+
+}
+
+std::uint64_t common::fingerprint(const std::vector<common::diagnostic>& diags)
+{
+    common::fingerprint_builder h;
+    h.mix(diags.size());
+    for (auto& d : diags)
+        mix(h, d);
+    return h.get();
+}
@@ -2,6 +2,7 @@
 #ifndef COMMON_DIAGNOSTICS_H
 #define COMMON_DIAGNOSTICS_H
 
+#include <cstdint>
 #include <variant>
 #include <vector>
 #include <string_view>
@@ -39,6 +40,30 @@ class diagnostic
     diagnostic& operator<<(int arg);
 };
 
+// Build a fingerprint out of values mixed one after the other, with FNV-1a.
+// Unlike std::hash, it gives the same fingerprint from one run to the next
+class fingerprint_builder
+{
+    public:
+
+    void mix(std::uint64_t);
+    // the size is mixed too, which keeps "ab" "c" apart from "a" "bc"
+    void mix(std::string_view);
+
+    std::uint64_t get() const { return h; }
+
+    private:
+
+    void mix(const void*, std::size_t);
+
+    std::uint64_t h = 14695981039346656037ull;
+};
+
+// Identify a set of diagnostics without formatting them: sets which would be
+// formatted the same get the same fingerprint. The order of the diagnostics
+// matters, and so do their notes
+std::uint64_t fingerprint(const std::vector<diagnostic>&);
+
 }
 
 #endif
@@ -0,0 +1,59 @@
+
+#include "common/histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+double common::histogram::snapshot::percentile(double p) const
+{
+    if (count == 0)
+        return 0;
+
+    auto rank = static_cast<std::uint64_t>(std::ceil(p * count));
+    if (rank == 0)
+        rank = 1;
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < number_of_buckets; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(upper_bound_ms(i), max_ms);
+    }
+    return max_ms;
+}
+
+double common::histogram::upper_bound_ms(std::size_t bucket)
+{
+    return std::ldexp(1.0, static_cast<int>(bucket)) / 1000.0;
+}
+
+void common::histogram::record(std::chrono::steady_clock::duration d)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    auto value = us > 0 ? static_cast<std::uint64_t>(us) : 0;
+
+    auto bucket = std::min<std::size_t>(std::bit_width(value),
+                                        number_of_buckets - 1);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    total_us_.fetch_add(value, std::memory_order_relaxed);
+
+    auto max = max_us_.load(std::memory_order_relaxed);
+    while (value > max &&
+           !max_us_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+common::histogram::snapshot common::histogram::get() const
+{
+    snapshot s;
+    for (std::size_t i = 0; i < number_of_buckets; ++i)
+    {
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        s.count += s.buckets[i];
+    }
+    s.total_ms = total_us_.load(std::memory_order_relaxed) / 1000.0;
+    s.max_ms = max_us_.load(std::memory_order_relaxed) / 1000.0;
+    return s;
+}
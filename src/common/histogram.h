@@ -0,0 +1,50 @@
+
+#ifndef COMMON_HISTOGRAM_H
+#define COMMON_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace common
+{
+
+// A histogram of durations which many threads can record into without
+// locking. Bucket 0 counts durations under a microsecond, and bucket i the
+// durations from 2^(i-1) up to 2^i microseconds. Percentiles are therefore
+// only known up to a factor 2, which is what counters exposed at runtime
+// need: they are cheap to record and show where time goes.
+class histogram
+{
+    public:
+    static constexpr std::size_t number_of_buckets = 32;
+
+    struct snapshot
+    {
+        std::uint64_t count = 0;
+        double total_ms = 0;
+        double max_ms = 0;
+        std::array<std::uint64_t, number_of_buckets> buckets = {};
+
+        // upper bound of the bucket holding the given percentile, in
+        // milliseconds. 0 when empty
+        double percentile(double) const;
+    };
+
+    // the upper bound of a bucket, in milliseconds
+    static double upper_bound_ms(std::size_t);
+
+    void record(std::chrono::steady_clock::duration);
+    snapshot get() const;
+
+    private:
+    std::array<std::atomic<std::uint64_t>, number_of_buckets> buckets_ = {};
+    std::atomic<std::uint64_t> total_us_ = 0;
+    std::atomic<std::uint64_t> max_us_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+
+#ifndef COMMON_INPLACE_FUNCTION_H
+#define COMMON_INPLACE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace common
+{
+
+// A move-only std::function look-alike storing its callable inline. It never
+// allocates, and callables capturing move-only things are fine. A callable
+// that does not fit in Capacity bytes is a compile error rather than a silent
+// heap allocation.
+template <typename Signature, std::size_t Capacity = 64>
+class inplace_function;
+
+template <typename R, typename... Args, std::size_t Capacity>
+class inplace_function<R(Args...), Capacity>
+{
+    public:
+    inplace_function() = default;
+
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename = std::enable_if_t<
+                  !std::is_same_v<D, inplace_function> &&
+                  std::is_invocable_r_v<R, D&, Args...>>>
+    inplace_function(F&& f)
+    {
+        static_assert(sizeof(D) <= Capacity,
+                      "callable too large for inplace_function");
+        static_assert(alignof(D) <= alignof(std::max_align_t),
+                      "callable over-aligned for inplace_function");
+
+        new (storage_) D(std::forward<F>(f));
+
+        invoke_ = [](void* f, Args&&... args) -> R {
+            return (*static_cast<D*>(f))(std::forward<Args>(args)...);
+        };
+
+        // move the callable from src into dst and destroy it, or only
+        // destroy it when dst is nullptr
+        manage_ = [](void* dst, void* src) {
+            if (dst)
+                new (dst) D(std::move(*static_cast<D*>(src)));
+            static_cast<D*>(src)->~D();
+        };
+    }
+
+    inplace_function(inplace_function&& rhs) noexcept
+    {
+        take(rhs);
+    }
+
+    inplace_function& operator=(inplace_function&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            reset();
+            take(rhs);
+        }
+        return *this;
+    }
+
+    inplace_function(const inplace_function&) = delete;
+    inplace_function& operator=(const inplace_function&) = delete;
+
+    ~inplace_function()
+    {
+        reset();
+    }
+
+    explicit operator bool() const
+    {
+        return invoke_ != nullptr;
+    }
+
+    R operator()(Args... args)
+    {
+        return invoke_(storage_, std::forward<Args>(args)...);
+    }
+
+    private:
+    void take(inplace_function& rhs)
+    {
+        if (!rhs.invoke_)
+            return;
+
+        rhs.manage_(storage_, rhs.storage_);
+        invoke_ = rhs.invoke_;
+        manage_ = rhs.manage_;
+        rhs.invoke_ = nullptr;
+        rhs.manage_ = nullptr;
+    }
+
+    void reset()
+    {
+        if (manage_)
+            manage_(nullptr, storage_);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+
+    R (*invoke_)(void*, Args&&...) = nullptr;
+    void (*manage_)(void*, void*) = nullptr;
+};
+
+}
+
+#endif
@@ -11,7 +11,7 @@ serialize::json_reader::json_reader(json::string& json)
     reader_ = doc;
 }
 
-serialize::json_reader::json_reader(rapidjson::GenericValue<rapidjson::UTF8<>>* reader) : reader_(reader)
+serialize::json_reader::json_reader(const rapidjson::GenericValue<rapidjson::UTF8<>>* reader) : reader_(reader)
 {
 
 }
@@ -173,9 +173,11 @@ void serialize::execute(serialize::json_writer& writer, std::string& value)
     writer.string(value.c_str(), (rapidjson::SizeType) value.size());
 }
 
-/* void serialize::execute(serialize::json_reader&, std::string_view&)
+void serialize::execute(serialize::json_reader& reader, std::string_view& view)
 {
-    throw std::invalid_argument("std::string_view is not supported");
+    if (!reader.is_string())
+        throw std::invalid_argument("std::string_view");
+    view = reader.get_string_view();
 }
 
 void serialize::execute(serialize::json_writer& writer, std::string_view& data)
@@ -184,7 +186,7 @@ void serialize::execute(serialize::json_writer& writer, std::string_view& data)
         writer.string("");
     else
         writer.string(&data[0], (rapidjson::SizeType) data.size());
-}*/
+}
 
 void serialize::execute(serialize::json_reader& reader, json::null&)
 {
@@ -7,6 +7,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -21,11 +22,11 @@ namespace serialize {
 
 class json_reader
 {
-    rapidjson::GenericValue<rapidjson::UTF8<>>* reader_;
+    const rapidjson::GenericValue<rapidjson::UTF8<>>* reader_;
 
     public:
     json_reader(json::string& json);
-    json_reader(rapidjson::GenericValue<rapidjson::UTF8<>>* reader);
+    json_reader(const rapidjson::GenericValue<rapidjson::UTF8<>>* reader);
 
     bool is_json()
     {
@@ -95,6 +96,12 @@ class json_reader
         return reader_->GetString();
     }
 
+    // a view into the document being read, valid for as long as it is
+    std::string_view get_string_view()
+    {
+        return {reader_->GetString(), reader_->GetStringLength()};
+    }
+
     bool has_member(std::string x)
     {
         return reader_->HasMember(x);
@@ -596,6 +603,21 @@ inline T from_json(const json::string& json)
     return std::move(object);
 }
 
+//
+// Convert a value of a parsed document into a cpp data type, without parsing
+// it again. std::string_view members point into the document
+//
+template <typename T>
+inline T from_json(const rapidjson::Value& json)
+{
+    T object;
+
+    serialize::json_reader reader{&json};
+    execute(reader, object);
+
+    return object;
+}
+
 //
 // Convert a cpp data type into a json::string
 //
@@ -1,11 +1,43 @@
 
 #include "stringtable.h"
 
+#include <atomic>
+
+namespace
+{
+
+std::atomic<std::size_t> allocated_bytes = 0;
+
+}
+
+std::size_t common::stringtable::get_allocated_bytes()
+{
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+std::size_t common::stringtable::get_size_in_bytes() const
+{
+    std::size_t size = 0;
+    for (auto pg = current; pg; pg = pg->previous)
+        size += pg->size;
+
+    // a node of the index holds a hash, a view and two pointers
+    return size + table.size() * 4 * sizeof(void*);
+}
+
+common::stringtable::page* common::stringtable::allocate_page(std::size_t size)
+{
+    auto pg = (page* ) malloc(size);
+    pg->size = size;
+    pg->buffer = (char* ) pg + sizeof(page);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return pg;
+}
+
 common::stringtable::stringtable()
 {
-    current = (page* ) malloc(PAGE_SIZE);
+    current = allocate_page(PAGE_SIZE);
     current->previous = nullptr;
-    current->buffer = (char* ) current + sizeof(page);
 
     end = (char* ) current + PAGE_SIZE;
 }
@@ -20,6 +52,7 @@ void common::stringtable::destroy()
     while (current)
     {
         page* previous = current->previous;
+        allocated_bytes.fetch_sub(current->size, std::memory_order_relaxed);
         free(current);
         current = previous;
     }
@@ -95,18 +128,16 @@ char* common::stringtable::allocate(size_t size)
 
 char* common::stringtable::actually_allocate_before(size_t size)
 {
-    auto pg = (page* ) malloc(size + sizeof(page));
+    auto pg = allocate_page(size + sizeof(page));
     pg->previous = current->previous;
-    pg->buffer = (char* ) pg + sizeof(page);
     current->previous = pg;
     return pg->buffer;
 }
 
 char* common::stringtable::actually_allocate_after(size_t size)
 {
-    auto pg = (page* ) malloc(PAGE_SIZE);
+    auto pg = allocate_page(PAGE_SIZE);
     pg->previous = current;
-    pg->buffer = (char* ) pg + sizeof(page);
     current = pg;
     end = (char* ) current + PAGE_SIZE;
     char* allocated = current->buffer;
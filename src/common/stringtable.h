@@ -2,6 +2,7 @@
 #ifndef COMMON_STRINGTABLE_H
 #define COMMON_STRINGTABLE_H
 
+#include <cstddef>
 #include <unordered_map>
 #include <string>
 #include <cstring>
@@ -27,6 +28,12 @@ class stringtable
     std::string_view get(const char* string, size_t size);
     std::string_view get(const std::string& string);
 
+    // bytes held by all the string tables of the program
+    static std::size_t get_allocated_bytes();
+
+    // bytes held by this string table, its pages and its index
+    std::size_t get_size_in_bytes() const;
+
     private:
 
     static constexpr int PAGE_SIZE = 4096;
@@ -36,7 +43,10 @@ class stringtable
     {
         page* previous;
         char* buffer;
+        std::size_t size;
     };
+
+    static page* allocate_page(std::size_t);
     page* current;
     char* end;
 
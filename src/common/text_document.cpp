@@ -0,0 +1,96 @@
+
+#include "common/text_document.h"
+
+#include <algorithm>
+#include <cstring>
+
+common::text_document::text_document(std::string text, int version)
+    : text_(std::move(text)), version_(version)
+{
+    index_lines(0, text_, line_offsets_);
+}
+
+void common::text_document::replace(std::string_view text, int version)
+{
+    text_.assign(text);
+    version_ = version;
+
+    line_offsets_.assign(1, 0);
+    index_lines(0, text_, line_offsets_);
+}
+
+bool common::text_document::replace(position from, position to,
+                                    std::string_view text, int version)
+{
+    auto begin = offset(from);
+    auto end = offset(to);
+    if (end < begin)
+        return false;
+
+    // the lines starting within the replaced text are gone, the lines of the
+    // new text take their place, and the lines after it move
+    auto first = std::upper_bound(line_offsets_.begin(), line_offsets_.end(),
+                                  begin);
+    auto last = std::upper_bound(first, line_offsets_.end(), end);
+
+    for (auto it = last; it != line_offsets_.end(); ++it)
+        *it = *it - (end - begin) + text.size();
+
+    std::vector<std::size_t> inserted;
+    index_lines(begin, text, inserted);
+
+    auto at = line_offsets_.erase(first, last);
+    line_offsets_.insert(at, inserted.begin(), inserted.end());
+
+    text_.replace(begin, end - begin, text);
+    version_ = version;
+    return true;
+}
+
+std::size_t common::text_document::offset(position p) const
+{
+    if (p.line >= line_offsets_.size())
+        return text_.size();
+
+    auto i = line_offsets_[p.line];
+    auto end = p.line + 1 < line_offsets_.size() ? line_offsets_[p.line + 1]
+                                                 : text_.size();
+
+    // walk the utf-8 sequences of the line, counting utf-16 code units. Code
+    // points beyond the basic multilingual plane take two of them
+    std::size_t units = 0;
+    while (i < end && units < p.character)
+    {
+        auto c = static_cast<unsigned char>(text_[i]);
+        if (c == '\n' || (c == '\r' && i + 1 < end && text_[i + 1] == '\n'))
+            break;
+
+        std::size_t length = 1;
+        if (c >= 0xf0)
+            length = 4, units += 2;
+        else if (c >= 0xe0)
+            length = 3, units += 1;
+        else if (c >= 0xc0)
+            length = 2, units += 1;
+        else
+            units += 1;
+
+        i += std::min(length, end - i);
+    }
+
+    return i;
+}
+
+void common::text_document::index_lines(std::size_t base, std::string_view text,
+                                        std::vector<std::size_t>& offsets)
+{
+    auto start = text.data();
+    auto end = text.data() + text.size();
+    for (auto p = start; p < end; ++p)
+    {
+        p = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!p)
+            break;
+        offsets.push_back(base + (p - start) + 1);
+    }
+}
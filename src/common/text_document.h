@@ -0,0 +1,64 @@
+
+#ifndef COMMON_TEXT_DOCUMENT_H
+#define COMMON_TEXT_DOCUMENT_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace common
+{
+
+// The content of a document open in the editor, kept up to date with the
+// changes the editor sends, so that it can be analysed without saving it.
+//
+// The text is kept contiguous, because that is what the parsers want, along
+// with the offset of the beginning of each line. A change is located with the
+// line offsets and spliced in. The line offsets following the change are
+// shifted rather than recomputed.
+//
+// Positions are zero based. Characters are counted in UTF-16 code units, as
+// editors speaking the language server protocol do. The text itself is UTF-8
+class text_document
+{
+    public:
+    struct position
+    {
+        std::size_t line = 0;
+        std::size_t character = 0;
+    };
+
+    text_document() = default;
+    text_document(std::string, int);
+
+    // Replace the whole text
+    void replace(std::string_view, int);
+
+    // Replace the text between two positions. Positions past the end of a
+    // line or past the end of the document are clamped. Returns false if the
+    // range is reversed, in which case nothing is changed
+    bool replace(position, position, std::string_view, int);
+
+    const std::string& text() const { return text_; }
+    int version() const { return version_; }
+    std::size_t lines() const { return line_offsets_.size(); }
+
+    // Return the offset into the text of a position, clamped as above
+    std::size_t offset(position) const;
+
+    private:
+    static void index_lines(std::size_t, std::string_view,
+                            std::vector<std::size_t>&);
+
+    std::string text_;
+    int version_ = 0;
+
+    // the offset of the first character of each line. There is always at
+    // least one line
+    std::vector<std::size_t> line_offsets_ = {0};
+};
+
+}
+
+#endif
@@ -0,0 +1,164 @@
+
+#include "common/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+#include "common/loguru.h"
+
+namespace
+{
+
+std::mutex mutex;
+std::FILE* output = nullptr;
+std::string buffer;
+bool empty = true;
+std::chrono::steady_clock::time_point origin;
+
+// a trace is written out every so often rather than at every span
+constexpr std::size_t flush_threshold = 1 << 20;
+
+// threads get small ids, in the order they first record something. They
+// tell their name the first time they record into a trace
+std::atomic<int> next_thread_id = 1;
+std::atomic<int> trace_generation = 0;
+thread_local int thread_id = 0;
+thread_local int named_in_generation = -1;
+
+void escape(std::string& out, std::string_view s)
+{
+    for (auto c : s)
+    {
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", c);
+                out += code;
+            }
+            else
+                out += c;
+        }
+    }
+}
+
+long long microseconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+// mutex must be held
+void separate()
+{
+    if (!empty)
+        buffer += ",\n";
+    empty = false;
+}
+
+// mutex must be held
+void flush()
+{
+    if (!output || buffer.empty())
+        return;
+
+    std::fwrite(buffer.data(), 1, buffer.size(), output);
+    std::fflush(output);
+    buffer.clear();
+}
+
+}
+
+bool common::trace::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (output)
+        return true;
+
+    output = std::fopen(path.c_str(), "w");
+    if (!output)
+        return false;
+
+    origin = std::chrono::steady_clock::now();
+    trace_generation++;
+    buffer = "[\n";
+    empty = true;
+    flush();
+
+    enabled.store(true);
+    return true;
+}
+
+void common::trace::stop()
+{
+    enabled.store(false);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!output)
+        return;
+
+    buffer += "\n]\n";
+    flush();
+    std::fclose(output);
+    output = nullptr;
+}
+
+void common::trace::complete(std::string_view name, std::string_view file,
+                             std::chrono::steady_clock::time_point begin,
+                             std::chrono::steady_clock::time_point end)
+{
+    if (!enabled.load(std::memory_order_relaxed))
+        return;
+
+    if (thread_id == 0)
+        thread_id = next_thread_id++;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!output)
+        return;
+
+    auto generation = trace_generation.load();
+    if (named_in_generation != generation)
+    {
+        char thread_name[64];
+        loguru::get_thread_name(thread_name, sizeof(thread_name), false);
+
+        separate();
+        buffer += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":";
+        buffer += std::to_string(thread_id);
+        buffer += ",\"args\":{\"name\":\"";
+        escape(buffer, thread_name);
+        buffer += "\"}}";
+        named_in_generation = generation;
+    }
+
+    auto ts = std::max(microseconds(begin - origin), 0ll);
+    auto dur = std::max(microseconds(end - origin) - ts, 0ll);
+
+    separate();
+    buffer += "{\"ph\":\"X\",\"name\":\"";
+    escape(buffer, name);
+    buffer += "\",\"pid\":1,\"tid\":";
+    buffer += std::to_string(thread_id);
+    buffer += ",\"ts\":";
+    buffer += std::to_string(ts);
+    buffer += ",\"dur\":";
+    buffer += std::to_string(dur);
+    if (!file.empty())
+    {
+        buffer += ",\"args\":{\"file\":\"";
+        escape(buffer, file);
+        buffer += "\"}";
+    }
+    buffer += "}";
+
+    if (buffer.size() > flush_threshold)
+        flush();
+}
@@ -0,0 +1,96 @@
+
+#ifndef COMMON_TRACE_H
+#define COMMON_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+// Spans are compiled in unless the build defines VHDLSTUFF_TRACE=0. When
+// compiled in, a span costs one relaxed atomic load until tracing is started.
+#ifndef VHDLSTUFF_TRACE
+#define VHDLSTUFF_TRACE 1
+#endif
+
+namespace common
+{
+
+// Chrome trace-event output. Once started, spans on every thread are written
+// to a json file which chrome://tracing and https://ui.perfetto.dev can open.
+// Each thread shows under the name loguru knows it by.
+//
+// The file is a json array which is only closed by stop(). Both viewers load
+// a trace whose process died before then.
+namespace trace
+{
+
+// Start writing spans to the given file. Returns false if it cannot be opened
+bool start(const std::string&);
+
+// Write what is left, and close the file
+void stop();
+
+inline std::atomic_bool enabled = false;
+
+// Record a span which already happened, eg the time a task spent queued
+void complete(std::string_view name, std::string_view file,
+              std::chrono::steady_clock::time_point begin,
+              std::chrono::steady_clock::time_point end);
+
+// A span covers the lifetime of the object. The name and the file must
+// outlive the span
+class span
+{
+    public:
+    explicit span(std::string_view name, std::string_view file = {})
+    {
+        if (enabled.load(std::memory_order_relaxed))
+        {
+            name_ = name;
+            file_ = file;
+            begin_ = std::chrono::steady_clock::now();
+            active_ = true;
+        }
+    }
+
+    span(const span&) = delete;
+    span& operator=(const span&) = delete;
+
+    ~span()
+    {
+        if (active_)
+            complete(name_, file_, begin_, std::chrono::steady_clock::now());
+    }
+
+    private:
+    std::string_view name_;
+    std::string_view file_;
+    std::chrono::steady_clock::time_point begin_;
+    bool active_ = false;
+};
+
+}
+
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#if VHDLSTUFF_TRACE
+// TRACE_SPAN("parse", filename) traces the rest of the enclosing scope
+#define TRACE_SPAN(...) \
+    common::trace::span TRACE_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+// the arguments are only evaluated while tracing
+#define TRACE_COMPLETE(...)                                           \
+    do                                                                \
+    {                                                                 \
+        if (common::trace::enabled.load(std::memory_order_relaxed))   \
+            common::trace::complete(__VA_ARGS__);                     \
+    } while (0)
+#else
+#define TRACE_SPAN(...) static_cast<void>(0)
+#define TRACE_COMPLETE(...) static_cast<void>(0)
+#endif
+
+#endif
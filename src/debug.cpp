@@ -37,6 +37,8 @@
 
 #include "args.hxx"
 #include "loguru.h"
+#include "common/scope_guard.h"
+#include "common/trace.h"
 
 int debug_tokens(std::string file, std::filesystem::path path, bool stats = false)
 {
@@ -86,6 +88,7 @@ int debug_tokens(std::string file, std::filesystem::path path, bool stats = fals
     common::stringtable st;
     std::vector<common::diagnostic> diags;
 
+    TRACE_SPAN("lex", file);
     auto one = std::chrono::high_resolution_clock::now();
     vhdl::lexer lexer(&buffer[0], &buffer[buffer.length()], &st, &diags, p.string());
     lexer.scan();
@@ -106,6 +109,58 @@ int debug_tokens(std::string file, std::filesystem::path path, bool stats = fals
     return diags.size() == 0? 0 : 1 << 2;
 }
 
+// Count the names and expressions of a vhdl syntax tree. Used to compare the
+// virtual traverse() with the statically dispatched traverse_static()
+class node_counter: public vhdl::syntax::visitor
+{
+    public:
+    using vhdl::syntax::visitor::visit;
+
+    bool visit(vhdl::syntax::name* n) override
+    {
+        ++names;
+        return true;
+    }
+
+    bool visit(vhdl::syntax::expression* e) override
+    {
+        ++expressions;
+        return true;
+    }
+
+    std::size_t names = 0;
+    std::size_t expressions = 0;
+};
+
+int debug_traverse(std::filesystem::path path, std::string work, int rounds)
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree(path.string(), manager, work);
+    tree.update();
+
+    auto file = tree.get_main_file();
+    if (!file)
+        throw std::invalid_argument(fmt::format("Unable to open {}", path.string()));
+
+    auto time = [&](auto&& traverse) {
+        node_counter c;
+        auto one = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < rounds; ++i)
+            traverse(c);
+        auto two = std::chrono::high_resolution_clock::now();
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(two-one).count();
+        return std::make_tuple(us, c.names / rounds, c.expressions / rounds);
+    };
+
+    auto [v, names, expressions] = time([&](node_counter& c) { file->traverse(c); });
+    auto [t, names2, expressions2] = time([&](node_counter& c) { file->traverse_static(c); });
+
+    std::cout << names << " names, " << expressions << " expressions\n";
+    std::cout << "traverse:        " << v << "us / " << rounds << " rounds\n";
+    std::cout << "traverse_static: " << t << "us / " << rounds << " rounds\n";
+    return names == names2 && expressions == expressions2 ? 0 : 1;
+}
+
 int debug_analysis(std::string file, std::filesystem::path path, std::string work, bool ast = false, bool stats = false)
 {
     auto cwd = std::filesystem::current_path();
@@ -196,6 +251,7 @@ int main(int argc, char** argv)
 
     args::Flag                    k(parser, "tokens", "debug tokens",               {     "tokens"});
     args::Flag                    p(parser, "ast"   , "debug the parse ast",        {     "ast"});
+    args::ValueFlag<int>          b(parser, "rounds", "benchmark tree traversals",  {     "bench-traverse"});
 
     args::Flag                   s(parser, "stats"  , "print statistics",           {'s', "stats"});
     args::Flag                   v(parser, "version", "output version information", {'v', "version"});
@@ -217,6 +273,14 @@ int main(int argc, char** argv)
             throw args::ParseError("File is required");
         }
 
+        if (t && !common::trace::start(get(t)))
+        {
+            LOG_S(ERROR) << "Unable to write trace to " << get(t);
+        }
+        auto stop_trace = common::make_scope_guard([]() {
+            common::trace::stop();
+        });
+
         auto path = std::filesystem::path(f.Get());
         if (path.is_relative())
         {
@@ -228,6 +292,11 @@ int main(int argc, char** argv)
             return debug_tokens(f.Get(), path, s);
         }
 
+        if (b)
+        {
+            return debug_traverse(path, w.Get(), std::max(b.Get(), 1));
+        }
+
         return debug_analysis(f.Get(), path, w.Get(), p, s);
     }
     catch (const args::Completion& e)
@@ -0,0 +1,320 @@
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#if !WIN32
+#include <sys/resource.h>
+#endif
+
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "benchmark.h"
+#include "common/loguru.h"
+
+namespace
+{
+
+// The id of a request as it is written, so that 1 and "1" are told apart
+std::string id_of(const rapidjson::Value& id)
+{
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+    id.Accept(w);
+    return sb.GetString();
+}
+
+// Peak resident set size in kilobytes, if the platform tells
+std::optional<long> peak_rss_kb()
+{
+#if WIN32
+    return std::nullopt;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return std::nullopt;
+#if __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// Nearest rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double p)
+{
+    auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+}
+
+lsp::benchmark::benchmark(std::string& filename)
+: filename(filename),
+  path_to_journal(std::filesystem::path(filename).parent_path()),
+  reader(filename), current(reader.next())
+{
+}
+
+std::optional<std::string> lsp::benchmark::read()
+{
+    // initialize must be answered before anything else is sent
+    if (initializing)
+    {
+        wait_for_outstanding_requests();
+        initializing = false;
+    }
+
+    auto request = next_request();
+    if (!request)
+    {
+        wait_for_outstanding_requests();
+        stopped.store(true);
+        return request;
+    }
+
+    rapidjson::Document document;
+    document.Parse(request->c_str());
+    if (document.HasParseError() || !document.IsObject())
+        return request;
+
+    std::string method;
+    auto m = document.FindMember("method");
+    if (m != document.MemberEnd() && m->value.IsString())
+        method = m->value.GetString();
+
+    if (method == "shutdown" || method == "exit")
+        wait_for_outstanding_requests();
+
+    auto now = clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!first_request)
+        first_request = now;
+
+    // notifications, and responses to requests from the server, are not
+    // answered
+    auto id = document.FindMember("id");
+    if (id == document.MemberEnd() || method.empty())
+    {
+        number_of_notifications++;
+        return request;
+    }
+
+    number_of_requests++;
+    outstanding[id_of(id->value)] = {method, now};
+    initializing = method == "initialize";
+    return request;
+}
+
+void lsp::benchmark::write(const std::string& message)
+{
+    auto now = clock::now();
+
+    rapidjson::Document document;
+    document.Parse(message.c_str());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (document.HasParseError() || !document.IsObject() ||
+        document.HasMember("method") || !document.HasMember("id"))
+    {
+        number_of_server_messages++;
+        return;
+    }
+
+    auto it = outstanding.find(id_of(document["id"]));
+    if (it == outstanding.end())
+    {
+        number_of_server_messages++;
+        return;
+    }
+
+    std::chrono::duration<double, std::milli> latency = now - it->second.time;
+    latencies[it->second.method].push_back(latency.count());
+    outstanding.erase(it);
+
+    number_of_responses++;
+    last_response = now;
+    responded.notify_all();
+}
+
+bool lsp::benchmark::good()
+{
+    return !stopped.load();
+}
+
+lsp::connection::message_header lsp::benchmark::read_message_header()
+{
+    return {};
+}
+
+std::optional<std::string> lsp::benchmark::next_request()
+{
+    while (current.valid)
+    {
+        if (current.requests.size() > 0)
+        {
+            auto req = current.requests.front();
+            current.requests.pop_front();
+            return expand_journal_macros(std::get<std::string>(req),
+                                         path_to_journal);
+        }
+
+        current = reader.next();
+    }
+    return std::nullopt;
+}
+
+void lsp::benchmark::wait_for_outstanding_requests()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!outstanding.empty())
+    {
+        // the request sent first is the first to time out. Responses to the
+        // others do not give it more time
+        auto first = std::min_element(
+            outstanding.begin(), outstanding.end(), [](auto& a, auto& b) {
+                return a.second.time < b.second.time;
+            });
+        responded.wait_until(lock, first->second.time + timeout);
+
+        auto now = clock::now();
+        for (auto it = outstanding.begin(); it != outstanding.end();)
+        {
+            if (now - it->second.time < timeout)
+            {
+                ++it;
+                continue;
+            }
+
+            LOG_S(ERROR) << "TIMEOUT: " << filename << ": " << it->second.method
+                         << " " << it->first;
+            std::chrono::duration<double, std::milli> latency = timeout;
+            latencies[it->second.method].push_back(latency.count());
+            number_of_timeouts++;
+            it = outstanding.erase(it);
+        }
+    }
+}
+
+std::map<std::string, lsp::benchmark::summary> lsp::benchmark::summarize()
+{
+    std::map<std::string, summary> result;
+    for (auto& [method, values] : latencies)
+    {
+        auto sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+
+        auto& s = result[method];
+        s.count = sorted.size();
+        s.p50 = percentile(sorted, 0.50);
+        s.p90 = percentile(sorted, 0.90);
+        s.p99 = percentile(sorted, 0.99);
+        s.max = sorted.back();
+    }
+    return result;
+}
+
+double lsp::benchmark::elapsed_seconds()
+{
+    if (!first_request || !last_response)
+        return 0;
+
+    std::chrono::duration<double> elapsed = *last_response - *first_request;
+    return elapsed.count();
+}
+
+void lsp::benchmark::print_report(std::ostream& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto elapsed = elapsed_seconds();
+    auto rss = peak_rss_kb();
+
+    char line[256];
+    out << "Journal:    " << filename << "\n";
+    out << "Requests:   " << number_of_requests << " requests, "
+        << number_of_notifications << " notifications\n";
+    out << "Responses:  " << number_of_responses << " responses, "
+        << number_of_timeouts << " timed out, " << number_of_server_messages
+        << " messages from the server\n";
+
+    std::snprintf(line, sizeof(line), "Elapsed:    %.3f s\n", elapsed);
+    out << line;
+    if (elapsed > 0)
+    {
+        std::snprintf(line, sizeof(line), "Throughput: %.1f requests/s\n",
+                      number_of_responses / elapsed);
+        out << line;
+    }
+    if (rss)
+    {
+        std::snprintf(line, sizeof(line), "Peak RSS:   %.1f MiB\n",
+                      *rss / 1024.0);
+        out << line;
+    }
+
+    std::snprintf(line, sizeof(line), "\n%-36s %8s %10s %10s %10s %10s\n",
+                  "method", "count", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    out << line;
+    for (auto& [method, s] : summarize())
+    {
+        std::snprintf(line, sizeof(line),
+                      "%-36s %8zu %10.3f %10.3f %10.3f %10.3f\n",
+                      method.c_str(), s.count, s.p50, s.p90, s.p99, s.max);
+        out << line;
+    }
+    out.flush();
+}
+
+bool lsp::benchmark::write_report(const std::string& path)
+{
+    std::ofstream output(path);
+    if (!output.is_open())
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto elapsed = elapsed_seconds();
+    auto rss = peak_rss_kb();
+
+    rapidjson::StringBuffer sb;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> w(sb);
+
+    w.StartObject();
+    w.Key("journal");       w.String(filename.c_str());
+    w.Key("requests");      w.Uint64(number_of_requests);
+    w.Key("notifications"); w.Uint64(number_of_notifications);
+    w.Key("responses");     w.Uint64(number_of_responses);
+    w.Key("timeouts");      w.Uint64(number_of_timeouts);
+    w.Key("elapsed_s");     w.Double(elapsed);
+    w.Key("throughput");    w.Double(elapsed > 0 ? number_of_responses / elapsed : 0);
+    w.Key("peak_rss_kb");
+    if (rss)
+        w.Int64(*rss);
+    else
+        w.Null();
+    w.Key("methods");
+        w.StartObject();
+        for (auto& [method, s] : summarize())
+        {
+            w.Key(method.c_str());
+            w.StartObject();
+            w.Key("count");  w.Uint64(s.count);
+            w.Key("p50_ms"); w.Double(s.p50);
+            w.Key("p90_ms"); w.Double(s.p90);
+            w.Key("p99_ms"); w.Double(s.p99);
+            w.Key("max_ms"); w.Double(s.max);
+            w.EndObject();
+        }
+        w.EndObject();
+    w.EndObject();
+
+    output << sb.GetString() << std::endl;
+    return output.good();
+}
@@ -0,0 +1,97 @@
+
+#ifndef LSP_BENCHMARK_H
+#define LSP_BENCHMARK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "connection.h"
+
+namespace lsp
+{
+
+// The benchmark connection feeds the requests of a journal to the language
+// server as fast as it takes them, and measures how long each request takes
+// to be answered. The responses recorded in the journal are not compared.
+//
+// Requests go out without waiting for the previous ones to be answered,
+// except where the protocol says otherwise: nothing follows initialize until
+// it is answered, and shutdown and exit wait for every outstanding request.
+class benchmark: public connection
+{
+    public:
+    using clock = std::chrono::steady_clock;
+
+    // how long a request may wait for its response before it is given up on.
+    // Its latency is then recorded as that long, a lower bound
+    static constexpr std::chrono::seconds timeout{10};
+
+    benchmark(std::string&);
+
+    std::optional<std::string> read();
+    void write(const std::string&);
+
+    bool good();
+
+    // Latencies per method, throughput and peak memory, as text or as json
+    void print_report(std::ostream&);
+    bool write_report(const std::string&);
+
+    protected:
+    message_header read_message_header();
+
+    private:
+    struct sent
+    {
+        std::string method;
+        clock::time_point time;
+    };
+
+    struct summary
+    {
+        std::size_t count = 0;
+        double p50 = 0, p90 = 0, p99 = 0, max = 0; // milliseconds
+    };
+
+    std::optional<std::string> next_request();
+    void wait_for_outstanding_requests();
+    std::map<std::string, summary> summarize();
+    double elapsed_seconds();
+
+    std::string filename;
+    std::filesystem::path path_to_journal;
+    journal_reader reader;
+    journal_reader::transactions current;
+
+    bool initializing = false;
+    std::atomic_bool stopped = false;
+
+    // shared between read(), on the main thread, and write(), on the writer
+    // thread of the frontend
+    std::mutex mutex;
+    std::condition_variable responded;
+    std::unordered_map<std::string, sent> outstanding;
+    std::map<std::string, std::vector<double>> latencies;
+    std::optional<clock::time_point> first_request;
+    std::optional<clock::time_point> last_response;
+
+    std::size_t number_of_requests = 0;
+    std::size_t number_of_notifications = 0;
+    std::size_t number_of_responses = 0;
+    std::size_t number_of_server_messages = 0;
+    std::size_t number_of_timeouts = 0;
+};
+
+}
+
+#endif
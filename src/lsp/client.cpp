@@ -7,11 +7,15 @@ lsp::client::client(lsp::frontend* fe)
 
 }
 
-bool lsp::client::notify(std::string method, std::optional<json::string> params)
-{
+bool lsp::client::notify(
+    std::string method,
+    std::optional<json::string> params,
+    std::optional<std::string> key
+) {
     auto message = std::make_shared<lsp::outgoing_notification>();
     message->method = std::move(method);
     message->params = std::move(params);
+    message->key = std::move(key);
     return frontend->send(message);
 }
 
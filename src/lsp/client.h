@@ -14,7 +14,10 @@ class client
     client(lsp::frontend*);
     virtual ~client() = default;
 
-    bool notify(std::string method, std::optional<json::string>);
+    // a notification with a key supersedes a queued notification with the
+    // same method and key that has not been written yet
+    bool notify(std::string method, std::optional<json::string>,
+                std::optional<std::string> key = std::nullopt);
     bool request(
         std::string,
         std::optional<json::string>,
@@ -1,8 +1,19 @@
 
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
 #include <vector>
 #include <string_view>
 
+#if WIN32
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 #include "rapidjson/error/en.h"
 #include "rapidjson/reader.h"
 #include "rapidjson/writer.h"
@@ -49,25 +60,150 @@ bool lsp::connection::tee(std::string& filename)
     return tee_->is_valid();
 }
 
+namespace
+{
+
+constexpr std::size_t stdio_buffer_size = 64 * 1024;
+
+// Read at most n bytes from stdin. Return the number of bytes read, 0 at end
+// of file and a negative number on error
+long read_stdin(char* data, std::size_t n)
+{
+#if WIN32
+    n = std::min<std::size_t>(n, INT_MAX);
+    return _read(0, data, static_cast<unsigned int>(n));
+#else
+    while (true)
+    {
+        auto r = ::read(STDIN_FILENO, data, n);
+        if (r >= 0 || errno != EINTR)
+            return r;
+    }
+#endif
+}
+
+// Write the header and the body of a message to stdout, as a single write
+// unless the pipe only accepts part of it
+bool write_stdout(std::string_view header, std::string_view body)
+{
+#if WIN32
+    std::string message;
+    message.reserve(header.size() + body.size());
+    message.append(header).append(body);
+
+    const char* data = message.data();
+    std::size_t left = message.size();
+    while (left)
+    {
+        auto n = std::min<std::size_t>(left, INT_MAX);
+        auto w = _write(1, data, static_cast<unsigned int>(n));
+        if (w <= 0)
+            return false;
+        data += w;
+        left -= w;
+    }
+    return true;
+#else
+    iovec iov[2] = {
+        { const_cast<char*>(header.data()), header.size() },
+        { const_cast<char*>(body.data()),   body.size()   },
+    };
+
+    iovec* v = iov;
+    int count = 2;
+    while (count)
+    {
+        auto w = ::writev(STDOUT_FILENO, v, count);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        // skip what was written, there may be a partial iovec left
+        auto n = static_cast<std::size_t>(w);
+        while (count && n >= v->iov_len)
+        {
+            n -= v->iov_len;
+            ++v;
+            --count;
+        }
+        if (count)
+        {
+            v->iov_base = static_cast<char*>(v->iov_base) + n;
+            v->iov_len -= n;
+        }
+    }
+    return true;
+#endif
+}
+
+}
+
+lsp::stdio::stdio()
+: buffer_(stdio_buffer_size)
+{
+}
+
+bool lsp::stdio::fill()
+{
+    // move the unconsumed bytes to the front. They are at most a partial
+    // header, or the beginning of the next message
+    if (begin_ == end_)
+    {
+        begin_ = end_ = 0;
+    }
+    else if (begin_ > 0)
+    {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+
+    // a header line longer than the buffer, grow it
+    if (end_ == buffer_.size())
+        buffer_.resize(buffer_.size() * 2);
+
+    auto n = read_stdin(buffer_.data() + end_, buffer_.size() - end_);
+    if (n <= 0)
+    {
+        good_ = false;
+        return false;
+    }
+
+    end_ += n;
+    return true;
+}
+
 lsp::connection::message_header lsp::stdio::read_message_header()
 {
-    std::string str;
     const std::string_view content_length("Content-Length: ");
 
     lsp::connection::message_header header;
 
-    while (good_ && !std::cin.fail() && !std::cin.eof())
+    while (good_)
     {
-        auto c = std::cin.get();
-        if (c == '\n') {
-            if (str.empty())
-                return header;
-            if (!str.compare(0, content_length.size(), content_length))
-                header.content_length = atoi(str.c_str() + content_length.size());
-            str.clear();
-        } else if (c != '\r') {
-            str += c;
+        auto first = buffer_.data() + begin_;
+        auto eol = static_cast<const char*>(
+            std::memchr(first, '\n', end_ - begin_));
+        if (!eol)
+        {
+            if (!fill())
+                break;
+            continue;
         }
+
+        std::string_view line(first, eol - first);
+        begin_ += line.size() + 1;
+
+        if (line.size() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty())
+            return header;
+        if (line.starts_with(content_length))
+            std::from_chars(line.data() + content_length.size(),
+                            line.data() + line.size(), header.content_length);
     }
 
     good_ = false;
@@ -79,21 +215,29 @@ std::optional<std::string> lsp::stdio::read()
 {
     auto header = read_message_header();
 
+    if (!good_ || header.content_length == 0)
+    {
+        return std::nullopt;
+    }
+
     std::string str;
     str.resize(header.content_length);
-    for (int i = 0; i < header.content_length; ++i)
+
+    // whatever was buffered along with the header first, and then the rest
+    // of the body straight into the message
+    std::size_t size = std::min<std::size_t>(end_ - begin_, str.size());
+    std::memcpy(str.data(), buffer_.data() + begin_, size);
+    begin_ += size;
+
+    while (size < str.size())
     {
-        if (std::cin.fail() || std::cin.eof())
+        auto n = read_stdin(str.data() + size, str.size() - size);
+        if (n <= 0)
         {
             good_ = false;
-            break;
+            return std::nullopt;
         }
-        str[i] = std::cin.get();
-    }
-
-    if (!good_ || header.content_length == 0)
-    {
-        return std::nullopt;
+        size += n;
     }
 
     if (tee_)
@@ -104,25 +248,27 @@ std::optional<std::string> lsp::stdio::read()
 
 void lsp::stdio::write(const std::string& message)
 {
-    if (!good_ || !std::cout.good())
-    {
-        good_ = false;
+    if (!good_)
         return;
-    }
 
     std::lock_guard<std::mutex> guard(lock_);
 
     if (tee_)
         tee_->dump_write(message);
 
-    std::cout <<
-        "Content-Length: " << message.length() <<
+    char header[64] = "Content-Length: ";
+    auto first = header + std::strlen(header);
+    auto [last, ec] = std::to_chars(first, header + sizeof header,
+                                    message.length());
 #if WIN32
-        "\n\n" << // this is needed for some reason that I cannot understand
+    const std::string_view separator("\n\n"); // this is needed for some reason that I cannot understand
 #else
-        "\r\n\r\n" <<
+    const std::string_view separator("\r\n\r\n");
 #endif
-        message << std::flush;
+    last = std::copy(separator.begin(), separator.end(), last);
+
+    if (!write_stdout(std::string_view(header, last - header), message))
+        good_ = false;
 }
 
 bool lsp::stdio::good()
@@ -333,6 +479,19 @@ template <typename OutputHandler> struct expand_all_macros
     bool this_is_a_yaml_object_key = false;
 };
 
+std::string lsp::expand_journal_macros(const std::string& json,
+                                      const std::filesystem::path& cwd)
+{
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> w(sb);
+    expand_all_macros<rapidjson::Writer<rapidjson::StringBuffer>> filter(w, cwd);
+
+    rapidjson::Reader reader;
+    rapidjson::StringStream ss(json.c_str());
+    reader.Parse(ss, filter);
+    return sb.GetString();
+}
+
 lsp::replay::replay(std::string& filename)
 : filename(filename), reader(filename), current(reader.next()),
   path_to_journal(std::filesystem::path(filename).parent_path())
@@ -403,15 +562,8 @@ lsp::replay::wait_for_response_or_else_get_next_request()
             number_of_requests_in_the_journal++;
             LOG_S(1) << "REQ: " << filename << ":" << std::get<0>(req);
 
-            rapidjson::StringBuffer sb;
-            rapidjson::Writer<rapidjson::StringBuffer> w(sb);
-            expand_all_macros<rapidjson::Writer<rapidjson::StringBuffer>>
-                filter(w, path_to_journal);
-
-            rapidjson::Reader reader;
-            rapidjson::StringStream ss(std::get<std::string>(req).c_str());
-            reader.Parse(ss, filter);
-            return sb.GetString();
+            return expand_journal_macros(std::get<std::string>(req),
+                                         path_to_journal);
         }
 
         if (current.responses.size() > 0)
@@ -419,15 +571,7 @@ lsp::replay::wait_for_response_or_else_get_next_request()
             while (current.responses.size() > 0)
             {
                 auto [line, something, expect] = current.responses.front();
-                rapidjson::StringBuffer sb;
-                rapidjson::Writer<rapidjson::StringBuffer> w(sb);
-                expand_all_macros<rapidjson::Writer<rapidjson::StringBuffer>>
-                    filter(w, path_to_journal);
-
-                rapidjson::Reader reader;
-                rapidjson::StringStream ss(expect.c_str());
-                reader.Parse(ss, filter);
-                std::string expected(sb.GetString());
+                auto expected = expand_journal_macros(expect, path_to_journal);
 
                 current.responses.pop_front();
                 number_of_responses_in_the_journal++;
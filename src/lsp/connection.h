@@ -14,6 +14,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace lsp
 {
@@ -41,6 +42,10 @@ class connection
 
     virtual bool good() = 0;
 
+    // whether queued notifications may be replaced by newer ones before they
+    // are written, eg diagnostics for the same file
+    virtual bool coalesce() { return true; }
+
     virtual bool tee(std::string&) final;
 
     protected:
@@ -57,9 +62,16 @@ class connection
 
 };
 
+// The stdio connection reads and writes the standard file descriptors
+// directly. Headers are parsed out of a large read buffer, bodies are read in
+// bulk straight into the message, and a message is written with a single
+// system call. didOpen and didChange payloads can be several megabytes, and
+// going through iostreams one character at a time dominates their cost.
 class stdio: public connection
 {
     public:
+    stdio();
+
     std::optional<std::string> read();
     void write(const std::string& message);
 
@@ -70,6 +82,13 @@ class stdio: public connection
     std::atomic_bool good_ = true;
     std::mutex       lock_;
 
+    // bytes read from stdin but not consumed yet are buffer_[begin_, end_)
+    std::vector<char> buffer_;
+    std::size_t       begin_ = 0;
+    std::size_t       end_ = 0;
+
+    bool fill();
+
     message_header read_message_header();
 };
 
@@ -91,6 +110,11 @@ class journal_reader
     transactions next();
 };
 
+// Expand the macros of a message read from a journal. ${file:<path>} is the
+// uri of <path>, relative to the folder of the journal
+std::string expand_journal_macros(const std::string&,
+                                  const std::filesystem::path&);
+
 template<typename T>
 class queue
 {
@@ -179,6 +203,9 @@ class replay: public connection
 
     bool good();
 
+    // journals expect every message the server sends, in order
+    bool coalesce() { return false; }
+
     protected:
 
     std::atomic_bool stopped = false;
@@ -3,10 +3,13 @@
 
 #include "connection.h"
 #include "server.h"
+#include "common/loguru.h"
+#include "common/trace.h"
 
 #include "rapidjson/document.h"
 #include "rapidjson/writer.h"
 
+#include <algorithm>
 #include <cstdarg>
 
 lsp::incoming_request::incoming_request(lsp::frontend* f, int i, common::cancellation_token&& t)
@@ -63,6 +66,8 @@ lsp::outgoing_request::outgoing_request(
 
 json::string lsp::outgoing_request::to_json() const
 {
+    TRACE_SPAN("serialize request");
+
     rapidjson::StringBuffer s;
     rapidjson::Writer<rapidjson::StringBuffer> writer(s);
 
@@ -101,6 +106,8 @@ json::string lsp::outgoing_request::to_json() const
 
 json::string lsp::outgoing_response::to_json() const
 {
+    TRACE_SPAN("serialize response");
+
     rapidjson::StringBuffer s;
     rapidjson::Writer<rapidjson::StringBuffer> writer(s);
 
@@ -194,6 +201,8 @@ json::string lsp::outgoing_response::to_json() const
 
 json::string lsp::outgoing_notification::to_json() const
 {
+    TRACE_SPAN("serialize notification");
+
     rapidjson::StringBuffer s;
     rapidjson::Writer<rapidjson::StringBuffer> writer(s);
 
@@ -224,7 +233,23 @@ json::string lsp::outgoing_notification::to_json() const
 
 lsp::frontend::frontend(lsp::connection* connection, lsp::server* server)
 : connection_(connection), server_(server), is_running_(true)
-{}
+{
+    writer = std::thread(&lsp::frontend::writer_loop, this);
+}
+
+lsp::frontend::~frontend()
+{
+    // the writer drains the queue before it stops, so that eg the reply to
+    // the shutdown request is written
+    {
+        std::lock_guard<std::mutex> g(outgoing_mutex);
+        writer_stopped = true;
+    }
+    outgoing_cv.notify_one();
+
+    if (writer.joinable())
+        writer.join();
+}
 
 bool lsp::frontend::forever_loop()
 {
@@ -263,8 +288,11 @@ void lsp::frontend::bind(std::string method, std::function<void(std::shared_ptr<
 
 bool lsp::frontend::handle(std::string msg)
 {
-    rapidjson::Document d;
-    d.Parse(msg);
+    auto message = std::make_shared<lsp::incoming_message>();
+    message->text = std::move(msg);
+
+    auto& d = message->document;
+    d.ParseInsitu(message->text.data());
 
     if (d.HasParseError())
     {
@@ -282,17 +310,12 @@ bool lsp::frontend::handle(std::string msg)
     bool is_response = d.HasMember("id") && !d.HasMember("method");
     bool is_notification = !d.HasMember("id") && d.HasMember("method");
 
+    const rapidjson::Value* params = nullptr;
+    if (auto it = d.FindMember("params"); it != d.MemberEnd())
+        params = &it->value;
+
     if (is_request)
     {
-        std::optional<json::string> params;
-        if (d.HasMember("params"))
-        {
-            rapidjson::StringBuffer s;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-            d["params"].Accept(writer);
-            params = std::make_optional<json::string>(s.GetString());
-        }
-
         std::variant<int, std::string> id;
         if (d["id"].IsInt())
             id = d["id"].GetInt();
@@ -304,7 +327,7 @@ bool lsp::frontend::handle(std::string msg)
             return false;
         }
 
-        return handle(id, d["method"].GetString(), std::move(params));
+        return handle(id, d["method"].GetString(), std::move(message), params);
     }
     else if (is_response)
     {
@@ -365,30 +388,29 @@ bool lsp::frontend::handle(std::string msg)
     }
     else if (is_notification)
     {
-        std::optional<json::string> params;
-        if (d.HasMember("params"))
-        {
-            rapidjson::StringBuffer s;
-            rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-            d["params"].Accept(writer);
-            params = std::make_optional<json::string>(s.GetString());
-        }
-
-        return handle(d["method"].GetString(), std::move(params));
+        return handle(d["method"].GetString(), std::move(message), params);
     }
 
     diagnose("Jsonrpc message isn't a request, response nor notification");
     return false;
 }
 
-bool lsp::frontend::handle(std::string method, std::optional<json::string> params)
-{
+bool lsp::frontend::handle(
+    std::string method,
+    std::shared_ptr<const lsp::incoming_message> incoming,
+    const rapidjson::Value* params
+) {
     if (method != "exit" && !server_->started_)
     {
         diagnose("Ignoring notification '%s' before initialization", method.c_str());
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> g(method_stats_mutex);
+        notifications_received[method]++;
+    }
+
     if (method == "exit")
     {
         handle_exit_notification();
@@ -396,10 +418,11 @@ bool lsp::frontend::handle(std::string method, std::optional<json::string> param
 
     if (method == "$/cancelRequest")
     {
-        lsp::incoming_notification message;
-        message.method = method;
-        message.params = std::move(params);
-        return handle_cancel_request_notification(std::move(message));
+        lsp::incoming_notification notification;
+        notification.method = method;
+        notification.message = std::move(incoming);
+        notification.params = params;
+        return handle_cancel_request_notification(std::move(notification));
     }
     auto it = notification_handlers.find(method);
     if (it == notification_handlers.end())
@@ -408,18 +431,21 @@ bool lsp::frontend::handle(std::string method, std::optional<json::string> param
         return false;
     }
 
-    auto message = std::make_shared<lsp::incoming_notification>();
-    message->method = method;
-    message->params = std::move(params);
+    auto notification = std::make_shared<lsp::incoming_notification>();
+    notification->method = method;
+    notification->message = std::move(incoming);
+    notification->params = params;
 
-    it->second(message);
+    TRACE_SPAN(notification->method);
+    it->second(notification);
 
     return true;
 }
 
 bool lsp::frontend::handle(
     std::variant<int, std::string> id, std::string method,
-    std::optional<json::string> params
+    std::shared_ptr<const lsp::incoming_message> incoming,
+    const rapidjson::Value* params
 ) {
     if (method == "initialize" && !server_->started_)
     {
@@ -474,9 +500,12 @@ bool lsp::frontend::handle(
     auto message = std::make_shared<lsp::incoming_request>(this, internal_request_id, source.token());
     message->id = id;
     message->method = method;
-    message->params = std::move(params);
+    message->received = std::chrono::steady_clock::now();
+    message->message = std::move(incoming);
+    message->params = params;
     incoming_requests_in_flight[id] = std::make_pair(source, message);
 
+    TRACE_SPAN(message->method);
     it->second(message);
 
     return true;
@@ -580,15 +609,13 @@ bool lsp::frontend::handle_exit_notification()
 
 bool lsp::frontend::handle_cancel_request_notification(lsp::incoming_notification notification)
 {
-    rapidjson::Document d;
-    d.Parse(notification.params.value().str);
-
-    if (d.HasParseError())
+    if (!notification.params)
     {
-        diagnose("Unable to parse cancel request");
+        diagnose("Cancel request missing params");
         return false;
     }
 
+    auto& d = *notification.params;
     if (!d.IsObject())
     {
         diagnose("Invalid cancel request");
@@ -632,7 +659,7 @@ int lsp::frontend::get_id_for_next_outgoing_request()
 
 bool lsp::frontend::send(std::shared_ptr<lsp::outgoing_notification> notification)
 {
-    connection_->write(notification->to_json().str);
+    enqueue({notification->method, notification->key, notification->to_json()});
     return true;
 }
 
@@ -643,7 +670,7 @@ bool lsp::frontend::send(std::shared_ptr<lsp::outgoing_request> request)
         outgoing_requests_in_flight[request->id] = request;
     }
 
-    connection_->write(request->to_json().str);
+    enqueue({request->method, std::nullopt, request->to_json()});
 
     return true;
 }
@@ -661,6 +688,12 @@ bool lsp::frontend::send(std::shared_ptr<lsp::outgoing_response> response)
         }
 
         request->replied_ = true;
+        {
+            auto latency = std::chrono::steady_clock::now() - request->received;
+            std::lock_guard<std::mutex> g(method_stats_mutex);
+            request_latencies[request->method].record(latency);
+        }
+
         std::lock_guard<std::mutex> g(incoming_requests_mutex);
         auto it = incoming_requests_in_flight.find(request->id);
         if (it != incoming_requests_in_flight.end())
@@ -672,11 +705,94 @@ bool lsp::frontend::send(std::shared_ptr<lsp::outgoing_response> response)
         }
     }
 
-    connection_->write(response->to_json().str);
+    enqueue({"", std::nullopt, response->to_json()});
 
     return true;
 }
 
+void lsp::frontend::enqueue(outgoing_message message)
+{
+    std::lock_guard<std::mutex> g(outgoing_mutex);
+
+    // a message of the same method without a key, eg the end of a progress,
+    // must still be written in between. Only what was queued after it can be
+    // superseded
+    if (message.key && connection_->coalesce())
+    {
+        for (auto it = outgoing_queue.rbegin(); it != outgoing_queue.rend();
+             ++it)
+        {
+            if (it->method != message.method)
+                continue;
+            if (!it->key)
+                break;
+            if (it->key != message.key)
+                continue;
+
+            *it = std::move(message);
+            outgoing_stats_.coalesced++;
+            return;
+        }
+    }
+
+    outgoing_queue.push_back(std::move(message));
+    outgoing_stats_.depth = outgoing_queue.size();
+    outgoing_stats_.max_depth = std::max(outgoing_stats_.max_depth,
+                                         outgoing_stats_.depth);
+    outgoing_cv.notify_one();
+}
+
+void lsp::frontend::writer_loop()
+{
+    loguru::set_thread_name("writer");
+
+    std::unique_lock<std::mutex> g(outgoing_mutex);
+
+    while (true)
+    {
+        outgoing_cv.wait(g, [&] {
+            return !outgoing_queue.empty() || writer_stopped;
+        });
+
+        if (outgoing_queue.empty())
+            return;
+
+        // take one message at a time. What is left in the queue can still be
+        // superseded while this one is being written
+        auto message = std::move(outgoing_queue.front());
+        outgoing_queue.pop_front();
+        outgoing_stats_.depth = outgoing_queue.size();
+
+        g.unlock();
+        {
+            TRACE_SPAN("write");
+            connection_->write(message.json.str);
+        }
+        g.lock();
+
+        outgoing_stats_.written++;
+    }
+}
+
+lsp::frontend::outgoing_stats lsp::frontend::get_outgoing_stats() const
+{
+    std::lock_guard<std::mutex> g(outgoing_mutex);
+    return outgoing_stats_;
+}
+
+std::map<std::string, lsp::frontend::method_stats>
+lsp::frontend::get_method_stats() const
+{
+    std::map<std::string, method_stats> stats;
+
+    std::lock_guard<std::mutex> g(method_stats_mutex);
+    for (auto& [method, latency] : request_latencies)
+        stats[method].latency = latency.get();
+    for (auto& [method, count] : notifications_received)
+        stats[method].notifications = count;
+    return stats;
+}
+
 void lsp::frontend::diagnose(const char* format, ...)
 {
     if (!on_diagnose_)
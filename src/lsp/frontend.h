@@ -2,17 +2,26 @@
 #ifndef LSP_FRONTEND_H
 #define LSP_FRONTEND_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <variant>
 
 #include "common/cancellation.h"
+#include "common/histogram.h"
 #include "common/json.h"
 
+#include "rapidjson/document.h"
+
 namespace lsp
 {
 
@@ -20,6 +29,16 @@ namespace lsp
 class frontend;
 class connection;
 
+// An incoming jsonrpc message, parsed once and in situ: the strings of the
+// document point into the text of the message. Requests and notifications
+// share ownership of the message they come from and hand their params to
+// handlers as a view into its document, so neither is copied
+struct incoming_message
+{
+    std::string text;
+    rapidjson::Document document;
+};
+
 struct incoming_request: std::enable_shared_from_this<incoming_request>
 {
     incoming_request(lsp::frontend*, int, common::cancellation_token&&);
@@ -32,7 +51,11 @@ struct incoming_request: std::enable_shared_from_this<incoming_request>
 
     std::variant<int, std::string> id;
     std::string method;
-    std::optional<json::string> params;
+    std::chrono::steady_clock::time_point received;
+
+    // the params of the request, or nullptr. They point into `message`
+    std::shared_ptr<const lsp::incoming_message> message;
+    const rapidjson::Value* params = nullptr;
 
     bool is_cancelled();
 
@@ -120,7 +143,10 @@ struct outgoing_response
 struct incoming_notification
 {
     std::string method;
-    std::optional<json::string> params;
+
+    // the params of the notification, or nullptr. They point into `message`
+    std::shared_ptr<const lsp::incoming_message> message;
+    const rapidjson::Value* params = nullptr;
 };
 
 struct outgoing_notification
@@ -128,6 +154,12 @@ struct outgoing_notification
     std::string method;
     std::optional<json::string> params;
 
+    // a notification with a key supersedes a notification with the same
+    // method and key that is still waiting to be written, eg diagnostics for
+    // the same uri or progress reports for the same token. Not across a
+    // notification of the same method without a key, eg the end of a progress
+    std::optional<std::string> key;
+
     json::string to_json() const;
 };
 
@@ -139,9 +171,30 @@ class frontend
 {
     public:
     frontend(lsp::connection* connection, lsp::server* server);
+    ~frontend();
 
     bool forever_loop();
 
+    struct outgoing_stats
+    {
+        std::size_t depth = 0;     // messages waiting to be written
+        std::size_t max_depth = 0; // the most messages ever waiting
+        std::size_t written = 0;
+        std::size_t coalesced = 0; // superseded before they were written
+    };
+
+    outgoing_stats get_outgoing_stats() const;
+
+    // how long requests took to be answered, and how many notifications were
+    // received, per method
+    struct method_stats
+    {
+        common::histogram::snapshot latency;
+        std::uint64_t notifications = 0;
+    };
+
+    std::map<std::string, method_stats> get_method_stats() const;
+
     void on_diagnose(std::function<void(std::string)> callback);
 
     // bind notification. When notification is received, call passed callback
@@ -159,7 +212,8 @@ class frontend
     // checked and it is an incoming request. handle it
     bool handle(
         std::variant<int, std::string> id, std::string method,
-        std::optional<json::string> params
+        std::shared_ptr<const lsp::incoming_message> incoming,
+        const rapidjson::Value* params
     );
 
     // got jsonrpc message and it is valid json
@@ -178,7 +232,11 @@ class frontend
 
     // got jsonrpc message and it is valid json
     // checked and it is an incoming notification. handle it
-    bool handle(std::string method, std::optional<json::string> params);
+    bool handle(
+        std::string method,
+        std::shared_ptr<const lsp::incoming_message> incoming,
+        const rapidjson::Value* params
+    );
 
     // special notifications need special handlers
     bool handle_exit_notification();
@@ -193,6 +251,30 @@ class frontend
     bool send(std::shared_ptr<lsp::outgoing_request> request);
     bool send(std::shared_ptr<lsp::outgoing_response> response);
 
+    // Messages are not written by the thread sending them but queued, and a
+    // single writer thread drains the queue. A slow client then only stalls
+    // the writer, not the file threads or the indexer
+    struct outgoing_message
+    {
+        std::string method;
+        std::optional<std::string> key;
+        json::string json;
+    };
+
+    void enqueue(outgoing_message message);
+    void writer_loop();
+
+    mutable std::mutex outgoing_mutex;
+    std::condition_variable outgoing_cv;
+    std::deque<outgoing_message> outgoing_queue;
+    outgoing_stats outgoing_stats_;
+    bool writer_stopped = false;
+    std::thread writer;
+
+    mutable std::mutex method_stats_mutex;
+    std::map<std::string, common::histogram> request_latencies;
+    std::map<std::string, std::uint64_t> notifications_received;
+
     std::map<std::string, std::function<void(std::shared_ptr<lsp::incoming_notification>)>> notification_handlers;
     std::map<std::string, std::function<void(std::shared_ptr<lsp::incoming_request>)>>      request_handlers;
 
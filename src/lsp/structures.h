@@ -5,6 +5,7 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "common/json.h"
 #include "common/location.h"
@@ -456,7 +457,10 @@ struct text_document_item
     document_uri uri;
     std::string language_id;
     int version;
-    std::string text;
+
+    // the content of the document can be megabytes long. It is a view into
+    // the message it was read from rather than a copy
+    std::string_view text;
 };
 
 SERIALIZABLE_STRUCT_BEGIN(text_document_item)
@@ -743,6 +747,35 @@ SERIALIZABLE_STRUCT_BEGIN(text_document_did_open_save_close_params)
 SERIALIZABLE_STRUCT_MEMBER_RENAMED(text_document, "textDocument")
 SERIALIZABLE_STRUCT_END()
 
+// a change to the content of a text document. Without a range, the text is
+// the whole new content of the document
+//
+// https://microsoft.github.io/language-server-protocol/specification#textdocumentcontentchangeevent
+struct text_document_content_change_event
+{
+    std::optional<lsp::range> range;
+
+    // a view into the message, like text_document_item::text
+    std::string_view text;
+};
+
+SERIALIZABLE_STRUCT_BEGIN(text_document_content_change_event)
+SERIALIZABLE_STRUCT_MEMBER(range)
+SERIALIZABLE_STRUCT_MEMBER(text)
+SERIALIZABLE_STRUCT_END()
+
+// https://microsoft.github.io/language-server-protocol/specification#didchangetextdocumentparams
+struct text_document_did_change_params
+{
+    lsp::versioned_text_document_identifier text_document;
+    std::vector<lsp::text_document_content_change_event> content_changes;
+};
+
+SERIALIZABLE_STRUCT_BEGIN(text_document_did_change_params)
+SERIALIZABLE_STRUCT_MEMBER_RENAMED(text_document, "textDocument")
+SERIALIZABLE_STRUCT_MEMBER_RENAMED(content_changes, "contentChanges")
+SERIALIZABLE_STRUCT_END()
+
 struct text_document_hover_params
 {
     lsp::text_document_item text_document;
@@ -1,6 +1,8 @@
 
 #include "sv/ast.h"
+#include "common/trace.h"
 
+#include <chrono>
 #include <unordered_set>
 #include <exception>
 
@@ -29,7 +31,14 @@ bool sv::ast::update()
     if (!invalidated_)
         return true;
 
-    auto buffer = sm.readSource(filename, nullptr);
+    TRACE_SPAN("update", filename);
+    auto start = std::chrono::steady_clock::now();
+    slang::SourceBuffer buffer;
+    if (main_file_text)
+        buffer = sm.assignText(filename, *main_file_text);
+    else if (auto read = sm.readSource(filename, nullptr))
+        buffer = *read;
+
     if (!buffer)
     {
         main_file.reset();
@@ -47,7 +56,9 @@ bool sv::ast::update()
     options.set(po);
     options.set(co);
 
-    main_file = slang::syntax::SyntaxTree::fromBuffer(*buffer, sm, options);
+    main_file = slang::syntax::SyntaxTree::fromBuffer(buffer, sm, options);
+    source_bytes += buffer.data.size();
+    get_statistics().parse.record(std::chrono::steady_clock::now() - start);
 
     auto lib = library_manager->get(worklibrary);
 
@@ -137,6 +148,7 @@ bool sv::ast::update()
                 continue;
             }
             auto tree = slang::syntax::SyntaxTree::fromBuffer(*buffer, sm, options);
+            source_bytes += buffer->data.size();
             tree->isLibrary = true;
             compilation.addSyntaxTree(tree);
             add_known_names(tree);
@@ -150,10 +162,36 @@ bool sv::ast::update()
         next_missing_names.clear();
     }
 
+    get_statistics().update.record(std::chrono::steady_clock::now() - start);
     invalidated_ = false;
     return false;
 }
 
+std::size_t sv::ast::get_memory_estimate()
+{
+    // roughly what slang takes to parse and elaborate, per byte of source
+    constexpr std::size_t bytes_per_source_byte = 24;
+    return source_bytes * bytes_per_source_byte;
+}
+
+sv::ast::statistics& sv::ast::get_statistics()
+{
+    static statistics stats;
+    return stats;
+}
+
+void sv::ast::set_main_file_text(std::string text, int version)
+{
+    main_file_text = std::move(text);
+    main_file_text_version = version;
+    invalidated_ = true;
+}
+
+std::optional<int> sv::ast::get_main_file_text_version()
+{
+    return main_file_text_version;
+}
+
 void sv::ast::invalidate_main_file()
 {
     invalidated_ = true;
@@ -2,7 +2,13 @@
 #ifndef SV_AST_H
 #define SV_AST_H
 
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "sv/library_manager.h"
+#include "common/histogram.h"
 
 #include "slang/util/Bag.h"
 #include "slang/ast/Compilation.h"
@@ -39,6 +45,17 @@ class ast
     // this function will return quickly
     void invalidate_reference_file(std::string&);
 
+    // this function will return quickly
+    // Parse the given text instead of reading the main file, eg the content of
+    // the file as it is being edited. The version identifies the text. Slang
+    // does not let a source manager forget a buffer, so this must be called
+    // before update()
+    void set_main_file_text(std::string, int);
+
+    // this function will return quickly
+    // Return the version of the text given to set_main_file_text(), if any
+    std::optional<int> get_main_file_text_version();
+
     // this function will return quickly
     // Note that the main file might be out of date if invalidate_x() functions
     // were called between the last update() and this one. However, the main
@@ -66,15 +83,35 @@ class ast
 
     std::string get_filename();
 
+    // this function will return quickly
+    // Estimate the memory held by this ast from the sources it parsed. The
+    // compilation is not measured, it is taken to be a multiple of the source
+    std::size_t get_memory_estimate();
+
+    // Counters shared by all asts
+    struct statistics
+    {
+        common::histogram parse;  // the main file
+        common::histogram update; // parse, and load the referenced files
+    };
+
+    static statistics& get_statistics();
+
     private:
 
     std::string filename;
     std::string worklibrary;
     std::vector<std::string> incdirs;
 
+    std::optional<std::string> main_file_text;
+    std::optional<int> main_file_text_version;
+
     std::shared_ptr<slang::syntax::SyntaxTree> main_file;
     std::shared_ptr<sv::library_manager> library_manager;
 
+    // the source buffers are never released by the source manager
+    std::size_t source_bytes = 0;
+
     public:
     slang::ast::Compilation compilation;
 
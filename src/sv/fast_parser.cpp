@@ -1,5 +1,6 @@
 
 #include "fast_parser.h"
+#include "common/trace.h"
 
 #include "slang/parsing/Parser.h"
 #include "slang/parsing/Preprocessor.h"
@@ -17,6 +18,8 @@ std::vector<std::tuple<sv::library_cell_kind, unsigned, unsigned, std::string,
                        std::optional<std::string>, std::string, time_t>>
 sv::fast_parser::parse()
 {
+    TRACE_SPAN("fast_parser", file);
+
     std::vector<
         std::tuple<sv::library_cell_kind, unsigned, unsigned, std::string,
                    std::optional<std::string>, std::string, time_t>>
@@ -101,12 +101,14 @@ void things::workdone_progress_bar::report(int percentage, std::string message)
     }
     else
     {
+        // only reports supersede each other, the begin and end notifications
+        // must all be written
         lsp::workdone_progress_report_params params;
         params.token = token_;
         params.message = message;
         params.percentage = percentage;
         auto json = serialize::to_json(params);
-        client_->notify("$/progress", json);
+        client_->notify("$/progress", json, token_);
     }
 }
 
@@ -152,7 +154,7 @@ void things::client::send_diagnostics(
     }
 
     auto json = serialize::to_json(params);
-    notify("textDocument/publishDiagnostics", json);
+    notify("textDocument/publishDiagnostics", json, params.uri.get_uri());
 }
 
 void things::client::send_diagnostics(
@@ -166,7 +168,7 @@ void things::client::send_diagnostics(
     }
 
     auto json = serialize::to_json(params);
-    notify("textDocument/publishDiagnostics", json);
+    notify("textDocument/publishDiagnostics", json, params.uri.get_uri());
 }
 
 void things::client::send_persistent_diagnostic(std::string file, lsp::diagnostic& diagnostic)
@@ -181,7 +183,7 @@ void things::client::send_persistent_diagnostic(std::string file, lsp::diagnosti
     params.diagnostics = diagnostics;
 
     auto json = serialize::to_json(params);
-    notify("textDocument/publishDiagnostics", json);
+    notify("textDocument/publishDiagnostics", json, params.uri.get_uri());
 }
 
 void things::client::clear_persistent_diagnostic(std::string file)
@@ -196,7 +198,7 @@ void things::client::clear_persistent_diagnostic(std::string file)
     params.diagnostics = diagnostics;
 
     auto json = serialize::to_json(params);
-    notify("textDocument/publishDiagnostics", json);
+    notify("textDocument/publishDiagnostics", json, params.uri.get_uri());
 }
 
 std::optional<things::workdone_progress_bar> things::client::create_workdone_progress(std::string t)
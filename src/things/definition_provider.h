@@ -38,6 +38,8 @@ class vhdl_definition_provider: public vhdl::syntax::visitor
     vhdl_definition_provider(rapidjson::Writer<rapidjson::StringBuffer>*, bool&, common::position);
     ~vhdl_definition_provider();
 
+    using vhdl::syntax::visitor::visit;
+
     virtual bool visit(vhdl::syntax::component_specification* c);
     virtual bool visit(vhdl::syntax::configuration_item* c);
 
@@ -2,7 +2,7 @@
 #ifndef THINGS_FOLDING_RANGE_PROVIDER_H
 #define THINGS_FOLDING_RANGE_PROVIDER_H
 
-#include "vhdl_syntax.h"
+#include "vhdl/outline.h"
 
 #include "slang/syntax/SyntaxVisitor.h"
 #include "slang/syntax/AllSyntax.h"
@@ -15,52 +15,16 @@
 namespace things
 {
 
-class vhdl_folding_range_provider: public vhdl::syntax::visitor
+class vhdl_folding_range_provider
 {
-    void foldable(std::optional<common::location> from, std::optional<common::location> to);
-    void foldable(common::location from, common::location to);
+    void foldable(common::position from, common::position to);
 
     public:
     vhdl_folding_range_provider(rapidjson::Writer<rapidjson::StringBuffer>*);
     ~vhdl_folding_range_provider();
 
-    virtual bool visit(vhdl::syntax::component_specification* c);
-    virtual bool visit(vhdl::syntax::configuration_item* c);
-
-    virtual bool visit(vhdl::syntax::block_configuration* b);
-    virtual bool visit(vhdl::syntax::component_configuration* c);
-    virtual bool visit(vhdl::syntax::subprogram* s);
-    virtual bool visit(vhdl::syntax::signature* s);
-    virtual bool visit(vhdl::syntax::type_definition* t);
-    virtual bool visit(vhdl::syntax::subtype* s);
-    virtual bool visit(vhdl::syntax::index_subtype* i);
-    virtual bool visit(vhdl::syntax::range* r);
-    virtual bool visit(vhdl::syntax::constraint* c);
-    virtual bool visit(vhdl::syntax::unit_declaration* u);
-    virtual bool visit(vhdl::syntax::physical_literal* p);
-    virtual bool visit(vhdl::syntax::element_declaration* e);
-    virtual bool visit(vhdl::syntax::declarative_item* d);
-    virtual bool visit(vhdl::syntax::object* i);
-    virtual bool visit(vhdl::syntax::interface* i);
-    virtual bool visit(vhdl::syntax::association_element* a);
-    virtual bool visit(vhdl::syntax::entity_specification* e);
-    virtual bool visit(vhdl::syntax::configuration_specification* c);
-    virtual bool visit(vhdl::syntax::binding_indication* b);
-    virtual bool visit(vhdl::syntax::name* n);
-    virtual bool visit(vhdl::syntax::expression* e);
-    virtual bool visit(vhdl::syntax::element_association* e);
-    virtual bool visit(vhdl::syntax::choice* c);
-    virtual bool visit(vhdl::syntax::sequential_statement* s);
-    virtual bool visit(vhdl::syntax::target* t);
-    virtual bool visit(vhdl::syntax::waveform_element* w);
-    virtual bool visit(vhdl::syntax::case_statement_alternative* c);
-    virtual bool visit(vhdl::syntax::concurrent_statement* c);
-    virtual bool visit(vhdl::syntax::con_waveform* c);
-    virtual bool visit(vhdl::syntax::sel_waveform* s);
-    virtual bool visit(vhdl::syntax::instantiated_unit* i);
-    virtual bool visit(vhdl::syntax::design_file* d);
-    virtual bool visit(vhdl::syntax::design_unit* d);
-    virtual bool visit(vhdl::syntax::context_item* c);
+    // the parser already found the foldable regions of the file
+    void operator()(const vhdl::outline&);
 
     private:
     rapidjson::Writer<rapidjson::StringBuffer>* w;
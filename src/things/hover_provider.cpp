@@ -383,11 +383,11 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::declarative_item* d)
 
         break;
     case vhdl::syntax::declarative_item::v_::object:
-        d->v.object.v->traverse(*this);
+        d->v.object.v->traverse_static(*this);
         break;
 
     case vhdl::syntax::declarative_item::v_::interface:
-        d->v.interface.v->traverse(*this);
+        d->v.interface.v->traverse_static(*this);
         break;
 
     case vhdl::syntax::declarative_item::v_::alias:
@@ -406,12 +406,12 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::declarative_item* d)
 
         if (d->v.component.gl__ < position && d->v.component.__gr > position)
             for (auto it: d->v.component.gens) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         if (d->v.component.pl__ < position && d->v.component.__pr > position)
             for (auto it: d->v.component.ports) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         return false;
     }
@@ -429,12 +429,12 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::declarative_item* d)
                 hover(d);
 
             if (d->v.subprogram_body.spec->v.function.result)
-                d->v.subprogram_body.spec->v.function.result->traverse(*this);
+                d->v.subprogram_body.spec->v.function.result->traverse_static(*this);
         }
 
         if (d->v.subprogram.pl__ < position && d->v.subprogram.__pr > position)
             for (auto it: d->v.subprogram.spec->parameters) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         return false;
     }
@@ -450,22 +450,22 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::declarative_item* d)
                 hover(d);
 
             if (d->v.subprogram_body.spec->v.function.result)
-                d->v.subprogram_body.spec->v.function.result->traverse(*this);
+                d->v.subprogram_body.spec->v.function.result->traverse_static(*this);
         }
 
         if (d->v.subprogram_body.pl__ < position && d->v.subprogram_body.__pr > position)
             for (auto it: d->v.subprogram_body.spec->parameters) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         if (d->v.subprogram_body.is__ < position && d->v.subprogram_body.__begin__ > position)
             for (auto it: d->v.subprogram_body.decls) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         if (d->v.subprogram_body.__begin__ < position && d->v.subprogram_body.__end > position)
             for (auto it: d->v.subprogram_body.stmts) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         return false;
@@ -612,7 +612,8 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::name* n)
         break;
     case vhdl::syntax::name::v_::selected:
         if (n->v.selected.identifier.location == position)
-            hover_identifier_denotes_entity(n->v.selected.identifier.value, n->denotes);
+            hover_identifier_denotes_entity(n->v.selected.identifier.value,
+                n->exports ? n->exports->entities : n->denotes);
         break;
     case vhdl::syntax::name::v_::slice:
     case vhdl::syntax::name::v_::fcall:
@@ -714,7 +715,7 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::design_unit* d)
         return false;
 
     for (auto it: d->contexts)
-        it->traverse(*this);
+        it->traverse_static(*this);
 
     if (d->first__ > position || d->__last < position)
         return false;
@@ -727,12 +728,12 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::design_unit* d)
 
         if (entity.gl__ < position && entity.__gr > position)
             for (auto it: entity.gens) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         if (entity.pl__ < position && entity.__pr > position)
             for (auto it: entity.ports) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         break;
     }
@@ -742,16 +743,16 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::design_unit* d)
             hover(d);
 
         if (d->first__ < position && architecture.is__ > position)
-            architecture.entity->traverse(*this);
+            architecture.entity->traverse_static(*this);
 
         if (architecture.is__ < position && architecture.__begin__ > position)
             for (auto it: architecture.decls) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
 
         if (architecture.__begin__ < position && architecture.__end > position)
             for (auto it: architecture.stmts) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         break;
     }
@@ -762,7 +763,7 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::design_unit* d)
 
         if (package.is__ < position && package.__end > position)
             for (auto it: package.decls) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         break;
     }
@@ -773,7 +774,7 @@ bool things::vhdl_hover_provider::visit(vhdl::syntax::design_unit* d)
 
         if (package.is__ < position && package.__end > position)
             for (auto it: package.decls) { if (found) break;
-                it->traverse(*this);
+                it->traverse_static(*this);
         }
         break;
     }
@@ -75,6 +75,8 @@ class vhdl_hover_provider: public vhdl::syntax::visitor
     void hover(vhdl::syntax::design_unit* d);
     void hover(vhdl::syntax::context_item* c, int);
 
+    using vhdl::syntax::visitor::visit;
+
     virtual bool visit(vhdl::syntax::component_specification* c);
     virtual bool visit(vhdl::syntax::configuration_item* c);
     virtual bool visit(vhdl::syntax::block_configuration* b);
@@ -2,20 +2,55 @@
 #include "language.h"
 
 #include "common/loguru.h"
+#include "sv/ast.h"
 #include "vhdl/ast.h"
 
+namespace
+{
+
+// params must be an object. A request without them is answered with an error
+bool has_params(const std::shared_ptr<lsp::incoming_request>& request)
+{
+    if (request->params && request->params->IsObject())
+        return true;
+
+    LOG_S(WARNING) << "Language Server " << request->method
+                   << " without params";
+    request->error(lsp::error_code::invalid_params, "params are missing",
+                   std::nullopt);
+    return false;
+}
+
+// and a notification without them is ignored
+bool has_params(const std::shared_ptr<lsp::incoming_notification>& notification)
+{
+    if (notification->params && notification->params->IsObject())
+        return true;
+
+    LOG_S(WARNING) << "Language Server " << notification->method
+                   << " without params";
+    return false;
+}
+
+}
+
 things::language::language(lsp::connection* connection)
     : server(connection), client(frontend.get()),
       project(std::bind(&things::language::update_all_working_files, this),
-              &client),
-      working_files(this, &client, false)
+              &client,
+              std::bind(&things::language::file_changed_on_disk, this,
+                        std::placeholders::_1, std::placeholders::_2)),
+      working_files(this, &client, false),
 // False there means that working_files will have a seperate thread for each
 // file that is `opened`
+      statistics(frontend.get(), &project, &working_files)
 {
     frontend->on_diagnose([](std::string diagnostic) {
         LOG_S(ERROR) << "Frontend: " << diagnostic;
     });
 
+    statistics.log_on_signal();
+
     LOG_S(INFO) << "Language Server constructed";
 }
 
@@ -39,6 +74,9 @@ void things::language::setup()
     //
     frontend->bind("workspace/didChangeWatchedFiles", std::bind(&things::language::on_workspace_did_change_watched_files, this, _1));
 
+    //
+    frontend->bind("vhdlstuff/stats", std::bind(&things::language::on_vhdlstuff_stats, this, _1));
+
 }
 
 void things::language::on_initialize(
@@ -46,14 +84,31 @@ void things::language::on_initialize(
 {
     LOG_S(INFO) << "Language Server initializing";
 
-    {
-    rapidjson::Document r;
-    r.Parse(request->params->str);
+    if (request->params && request->params->IsObject()) {
+    auto& r = *request->params;
     if (r.HasMember("rootUri") && r["rootUri"].IsString()) {
         lsp::document_uri rootUri(r["rootUri"].GetString());
 
         capabilities.root = rootUri.get_path();
     }
+
+    // how much memory the asts of open files may take, 0 for no limit
+    if (r.HasMember("initializationOptions") &&
+        r["initializationOptions"].IsObject()) {
+        auto& options = r["initializationOptions"];
+        if (options.HasMember("astMemoryBudgetMiB") &&
+            options["astMemoryBudgetMiB"].IsUint64())
+            working_files.set_memory_budget(
+                static_cast<std::size_t>(
+                    options["astMemoryBudgetMiB"].GetUint64()) << 20);
+
+        // the same for the files analysed before they are opened, 0 for none
+        if (options.HasMember("prefetchMemoryBudgetMiB") &&
+            options["prefetchMemoryBudgetMiB"].IsUint64())
+            working_files.set_prefetch_memory_budget(
+                static_cast<std::size_t>(
+                    options["prefetchMemoryBudgetMiB"].GetUint64()) << 20);
+    }
     }
 
     {
@@ -66,7 +121,8 @@ void things::language::on_initialize(
         w.Key("textDocumentSync");
             w.StartObject();
             w.Key("openClose"); w.Bool(true);
-            w.Key("change");    w.Uint(0);
+            // incremental
+            w.Key("change");    w.Uint(2);
             w.Key("save");      w.Bool(true);
             w.EndObject();
         w.Key("hoverProvider"); w.Bool(true);
@@ -110,10 +166,14 @@ void things::language::on_text_document_did_open(
 {
     LOG_S(INFO) << "Language Server textDocument/didOpen";
 
+    if (!has_params(notification))
+        return;
+
     auto param =
         serialize::from_json<lsp::text_document_did_open_save_close_params>(
-            notification->params.value());
-    working_files.update(param.text_document.uri.get_string());
+            *notification->params);
+    working_files.open(param.text_document.uri.get_string(),
+                       param.text_document.text, param.text_document.version);
 }
 
 void things::language::on_text_document_did_save(
@@ -121,10 +181,14 @@ void things::language::on_text_document_did_save(
 {
     LOG_S(INFO) << "Language Server textDocument/didSave";
 
+    if (!has_params(notification))
+        return;
+
     auto param =
         serialize::from_json<lsp::text_document_did_open_save_close_params>(
-            notification->params.value());
-    working_files.update(param.text_document.uri.get_string());
+            *notification->params);
+    working_files.update(param.text_document.uri.get_string(),
+                         things::priority::background);
 }
 
 void things::language::on_text_document_did_close(
@@ -132,9 +196,12 @@ void things::language::on_text_document_did_close(
 {
     LOG_S(INFO) << "Language Server textDocument/didClose";
 
+    if (!has_params(notification))
+        return;
+
     auto param =
         serialize::from_json<lsp::text_document_did_open_save_close_params>(
-            notification->params.value());
+            *notification->params);
     working_files.remove(param.text_document.uri.get_string());
 
     std::vector<lsp::diagnostic> empty;
@@ -145,6 +212,16 @@ void things::language::on_text_document_did_change(
     std::shared_ptr<lsp::incoming_notification> notification)
 {
     LOG_S(INFO) << "Language Server textDocument/didChange";
+
+    if (!has_params(notification))
+        return;
+
+    auto param = serialize::from_json<lsp::text_document_did_change_params>(
+        *notification->params);
+    auto& version = param.text_document.version;
+    working_files.change(param.text_document.uri.get_string(),
+                         version.is_null() ? 0 : version.value(),
+                         param.content_changes);
 }
 
 void things::language::on_text_document_folding_range(
@@ -152,8 +229,11 @@ void things::language::on_text_document_folding_range(
 {
     LOG_S(INFO) << "Language Server textDocument/foldingRange";
 
+    if (!has_params(request))
+        return;
+
     auto param = serialize::from_json<lsp::folding_range_params>(
-        request->params.value());
+        *request->params);
     working_files.folding_ranges(param.text_document.uri.get_string(), request);
 }
 
@@ -162,8 +242,11 @@ void things::language::on_text_document_symbol(
 {
     LOG_S(INFO) << "Language Server textDocument/documentSymbol";
 
+    if (!has_params(request))
+        return;
+
     auto param = serialize::from_json<lsp::document_symbols_params>(
-        request->params.value());
+        *request->params);
     working_files.symbols(param.text_document.uri.get_string(), request);
 }
 
@@ -172,8 +255,11 @@ void things::language::on_text_document_hover(
 {
     LOG_S(INFO) << "Language Server textDocument/hover";
 
+    if (!has_params(request))
+        return;
+
     auto param = serialize::from_json<lsp::text_document_hover_params>(
-        request->params.value());
+        *request->params);
     common::position pos(param.position.line + 1, param.position.character + 1);
     working_files.hover(param.text_document.uri.get_string(), request, pos);
 }
@@ -183,8 +269,11 @@ void things::language::on_text_document_definition(
 {
     LOG_S(INFO) << "Language Server textDocument/definition";
 
+    if (!has_params(request))
+        return;
+
     auto param = serialize::from_json<lsp::text_document_hover_params>(
-        request->params.value());
+        *request->params);
     common::position pos(param.position.line + 1, param.position.character + 1);
     working_files.definition(param.text_document.uri.get_string(), request, pos);
 }
@@ -193,7 +282,33 @@ void things::language::on_workspace_did_change_watched_files(
     std::shared_ptr<lsp::incoming_notification> notification)
 {
     LOG_S(INFO) << "Language Server workspace/didChangeWatchedFiles";
-    project.reload_yaml_reset_project_kick_background_index_destroy_libraries();
+
+    // the project watches its vhdl files, and only needs reloading when its
+    // configuration, or a systemverilog file, changes
+    bool reload = !project.is_watching_files();
+    if (has_params(notification) &&
+        (*notification->params).HasMember("changes") &&
+        (*notification->params)["changes"].IsArray())
+        for (auto& change : (*notification->params)["changes"].GetArray())
+        {
+            if (!change.HasMember("uri") || !change["uri"].IsString())
+                continue;
+
+            auto path = lsp::document_uri(change["uri"].GetString()).get_path();
+            auto ext = path.extension().string();
+            if (path.filename() == "vhdl_config.yaml" || sv::is_a_sv_file(ext))
+                reload = true;
+        }
+
+    if (reload)
+        project.reload_yaml_reset_project_kick_background_index_destroy_libraries();
+}
+
+void things::language::on_vhdlstuff_stats(
+    std::shared_ptr<lsp::incoming_request> request)
+{
+    LOG_S(INFO) << "Language Server vhdlstuff/stats";
+    request->reply(statistics.to_json());
 }
 
 void things::language::update_all_working_files()
@@ -201,3 +316,9 @@ void things::language::update_all_working_files()
     working_files.update_all_files();
 }
 
+void things::language::file_changed_on_disk(std::string file,
+                                            std::vector<std::string> dependents)
+{
+    working_files.changed_on_disk(file, dependents);
+}
+
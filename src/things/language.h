@@ -12,6 +12,7 @@
 
 #include "client.h"
 #include "project.h"
+#include "statistics.h"
 #include "working_files.h"
 
 namespace things
@@ -50,7 +51,11 @@ class language: public lsp::server
     //
     void on_workspace_did_change_watched_files(std::shared_ptr<lsp::incoming_notification>);
 
+    //
+    void on_vhdlstuff_stats(std::shared_ptr<lsp::incoming_request>);
+
     void update_all_working_files();
+    void file_changed_on_disk(std::string, std::vector<std::string>);
 
     things::capabilities capabilities;
 
@@ -59,6 +64,7 @@ class language: public lsp::server
     things::client client;
     things::working_files working_files;
     things::project project;
+    things::statistics statistics;
 
     friend class working_files;
     friend class project;
@@ -0,0 +1,185 @@
+
+#include "prefetcher.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "common/loguru.h"
+#include "common/scope_guard.h"
+#include "common/trace.h"
+
+things::prefetcher::prefetcher(things::project* p, things::thread_pool* pool)
+: project_(p), pool_(pool)
+{
+}
+
+bool things::prefetcher::is_known(const std::string& file)
+{
+    if (open_.count(file))
+        return true;
+
+    if (std::find(queue_.begin(), queue_.end(), file) != queue_.end())
+        return true;
+
+    return std::any_of(prefetched_.begin(), prefetched_.end(),
+                       [&file](auto& e) { return e.file == file; });
+}
+
+void things::prefetcher::suggest(const std::vector<std::string>& files)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopped_ || memory_budget_ == 0)
+        return;
+
+    for (auto& file : files)
+        if (!is_known(file))
+            queue_.push_back(file);
+
+    if (queue_.empty() || scheduled_)
+        return;
+    scheduled_ = true;
+    lock.unlock();
+
+    pool_->submit(shared_from_this());
+}
+
+std::optional<things::prefetcher::prefetched>
+things::prefetcher::open(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_.insert(file);
+
+    auto it = std::find_if(prefetched_.begin(), prefetched_.end(),
+                           [&file](auto& e) { return e.file == file; });
+    if (it == prefetched_.end())
+        return std::nullopt;
+
+    auto result = std::move(it->result);
+    prefetched_.erase(it);
+
+    // the working file would build a new ast anyway
+    if (result.project_version != project_->get_loaded_version())
+        return std::nullopt;
+
+    return result;
+}
+
+void things::prefetcher::close(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_.erase(file);
+}
+
+void things::prefetcher::invalidate(const std::string& file)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+
+    prefetched_.erase(
+        std::remove_if(prefetched_.begin(), prefetched_.end(),
+                       [&file](auto& e) { return e.file == file; }),
+        prefetched_.end());
+
+    // nothing else uses these asts
+    auto copy = file;
+    for (auto& e : prefetched_)
+        e.result.ast->invalidate_reference_file(copy);
+}
+
+void things::prefetcher::set_memory_budget(std::size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_budget_ = budget;
+    enforce_memory_budget();
+}
+
+void things::prefetcher::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    queue_.clear();
+    prefetched_.clear();
+}
+
+// mutex_ must be held
+void things::prefetcher::enforce_memory_budget()
+{
+    std::size_t total = 0;
+    for (auto& e : prefetched_)
+        total += e.memory;
+
+    while (prefetched_.size() && total > memory_budget_)
+    {
+        total -= prefetched_.front().memory;
+        prefetched_.pop_front();
+    }
+}
+
+things::strand::result things::prefetcher::run_one()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopped_ || queue_.empty() || memory_budget_ == 0 ||
+        !project_->libraries_have_been_populated())
+    {
+        queue_.clear();
+        scheduled_ = false;
+        return result::idle;
+    }
+
+    // whatever the user asks comes first
+    auto scheduler = project_->get_scheduler();
+    if (!scheduler->is_idle())
+        return result::deferred;
+
+    auto file = std::move(queue_.front());
+    queue_.pop_front();
+    auto generation = generation_;
+    lock.unlock();
+
+    std::optional<entry> built;
+    if (std::filesystem::exists(file))
+    {
+        scheduler->background_started();
+        auto finished = common::make_scope_guard([&]() {
+            scheduler->background_finished();
+        });
+
+        try
+        {
+            TRACE_SPAN("prefetch", file);
+
+            // built as the working file of the file would build it
+            auto version = project_->get_loaded_version();
+            auto libraries = project_->get_libraries_this_file_is_part_of(file);
+            auto ast = std::make_shared<vhdl::ast>(
+                file, project_->get_current_library_manager(),
+                libraries.size() ? libraries[0] : "work");
+            ast->update();
+
+            auto memory = ast->get_memory_estimate();
+            built = entry{file, {std::move(ast), version, std::move(libraries)},
+                          memory};
+        }
+        catch (const std::exception& e)
+        {
+            LOG_S(ERROR) << "Caught exception while prefetching " << file
+                         << ": " << e.what();
+        }
+    }
+
+    lock.lock();
+    if (built && !stopped_ && generation == generation_ && !open_.count(file))
+    {
+        prefetched_.push_back(std::move(*built));
+        enforce_memory_budget();
+    }
+
+    if (stopped_ || queue_.empty())
+    {
+        queue_.clear();
+        scheduled_ = false;
+        return result::idle;
+    }
+
+    return result::more;
+}
@@ -0,0 +1,107 @@
+
+#ifndef THINGS_PREFETCHER_H
+#define THINGS_PREFETCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "vhdl/ast.h"
+
+#include "project.h"
+#include "thread_pool.h"
+
+namespace things
+{
+
+// A user who opens a file often opens the files it depends on next, and the
+// architectures of the entities it instantiates. The prefetcher analyses
+// those files ahead of time, so that opening one of them finds its ast, and
+// the library units it needs, ready.
+//
+// It is a strand of the working files' pool, analysing one file at a time,
+// and only while the server is otherwise idle: no interactive request pending
+// and no background work running. It checks between files, and hands its
+// thread back to the pool as soon as that changes. The asts it built are kept
+// under a memory budget, the oldest being dropped first.
+class prefetcher: public std::enable_shared_from_this<prefetcher>,
+                  public things::strand
+{
+    public:
+    // files analysed for each file opened, at most
+    static constexpr std::size_t max_neighbours = 8;
+    static constexpr std::size_t default_memory_budget = std::size_t(256) << 20;
+
+    prefetcher(things::project*, things::thread_pool*);
+    prefetcher(const prefetcher&) = delete;
+    prefetcher(prefetcher&&) = delete;
+    prefetcher& operator=(const prefetcher&) = delete;
+    prefetcher& operator=(prefetcher&&) = delete;
+    ~prefetcher() = default;
+
+    // Queue files for analysis. Files open, analysed or queued already are
+    // skipped. Can be called from any thread
+    void suggest(const std::vector<std::string>&);
+
+    // An ast built by the prefetcher, and what it was built against
+    struct prefetched
+    {
+        std::shared_ptr<vhdl::ast> ast;
+        int project_version;
+        std::vector<std::string> work_libraries;
+    };
+
+    // Note that a file is open, and hand over its ast if it was prefetched
+    // against the current project
+    std::optional<prefetched> open(const std::string&);
+    void close(const std::string&);
+
+    // A file changed: drop its ast, and have the other asts reload what they
+    // loaded from it
+    void invalidate(const std::string&);
+
+    // 0 stops prefetching
+    void set_memory_budget(std::size_t);
+
+    void stop();
+
+    // things::strand
+    result run_one() override;
+
+    private:
+    things::project* project_;
+    things::thread_pool* pool_;
+
+    std::mutex mutex_;
+    std::deque<std::string> queue_;
+    bool scheduled_ = false;
+    bool stopped_ = false;
+    std::size_t memory_budget_ = default_memory_budget;
+
+    // the asts built, oldest first
+    struct entry
+    {
+        std::string file;
+        prefetched result;
+        std::size_t memory;
+    };
+    std::deque<entry> prefetched_;
+    std::unordered_set<std::string> open_;
+
+    // changes when asts are invalidated, so that the ast being built while
+    // that happens is dropped
+    std::uint64_t generation_ = 0;
+
+    bool is_known(const std::string&);
+    void enforce_memory_budget();
+};
+
+}
+
+#endif
@@ -2,11 +2,16 @@
 #include "project.h"
 #include "language.h"
 
+#include <algorithm>
+#include <deque>
 #include <regex>
+#include <set>
 #include <utility>
 
 #include "fmt/format.h"
 
+#include "common/trace.h"
+
 #include "slang/diagnostics/Diagnostics.h"
 #include "slang/parsing/Preprocessor.h"
 #include "slang/util/BumpAllocator.h"
@@ -15,6 +20,138 @@
 #include "vhdl/ast.h"
 #include "vhdl/fast_parser.h"
 
+namespace
+{
+
+std::string in_workspace(std::string path, const std::string& workspace_folder)
+{
+    if (path.rfind("${workspaceFolder}", 0) == 0)
+        path.replace(0, 18, workspace_folder);
+    return path;
+}
+
+// the directory to watch for the files of a spec: the one a query searches,
+// or the one a path is in
+things::watcher::directory
+directory_to_watch(const things::config::file_spec& spec,
+                   const std::string& workspace_folder)
+{
+    std::error_code ec;
+    if (spec.is_file_query())
+    {
+        std::filesystem::path folder(
+            in_workspace(spec.as_file_query().directory, workspace_folder));
+        return {std::filesystem::absolute(folder, ec).string(), true};
+    }
+
+    std::filesystem::path file(in_workspace(spec.as_path(), workspace_folder));
+    return {std::filesystem::absolute(file, ec).parent_path().string(), false};
+}
+
+// whether the explorer would find the file through the spec
+bool finds(const things::config::file_spec& spec,
+           const std::filesystem::path& file,
+           const std::string& workspace_folder)
+{
+    std::error_code ec;
+    if (spec.is_path())
+    {
+        std::filesystem::path path(
+            in_workspace(spec.as_path(), workspace_folder));
+        return std::filesystem::absolute(path, ec) == file;
+    }
+
+    auto& query = spec.as_file_query();
+    std::filesystem::path folder(in_workspace(query.directory, workspace_folder));
+    auto relative = file.lexically_relative(std::filesystem::absolute(folder, ec));
+    if (relative.empty() || *relative.begin() == "..")
+        return false;
+
+    std::regex regex(query.search, std::regex_constants::icase |
+                                       std::regex_constants::ECMAScript);
+    return std::regex_search(file.filename().string(), regex);
+}
+
+bool same_content(const things::config::file_spec& lhs,
+                  const things::config::file_spec& rhs)
+{
+    if (lhs.is_path() || rhs.is_path())
+        return lhs.is_path() && rhs.is_path() && lhs.as_path() == rhs.as_path();
+
+    auto& l = lhs.as_file_query();
+    auto& r = rhs.as_file_query();
+    return l.directory == r.directory && l.search == r.search &&
+           l.depth == r.depth;
+}
+
+bool same_specs(const things::config::library_spec& lhs,
+                const things::config::library_spec& rhs)
+{
+    if (lhs.name != rhs.name || lhs.files.size() != rhs.files.size() ||
+        lhs.incdirs.size() != rhs.incdirs.size())
+        return false;
+
+    for (std::size_t i = 0; i < lhs.files.size(); ++i)
+        if (!same_content(lhs.files[i], rhs.files[i]))
+            return false;
+
+    for (std::size_t i = 0; i < lhs.incdirs.size(); ++i)
+        if (lhs.incdirs[i].path != rhs.incdirs[i].path)
+            return false;
+
+    return true;
+}
+
+// whether the file or the folder of the spec is there, as the explorer checks
+bool can_be_explored(const things::config::file_spec& spec,
+                     const std::string& workspace_folder)
+{
+    std::error_code ec;
+    if (spec.is_path())
+        return std::filesystem::is_regular_file(
+            in_workspace(spec.as_path(), workspace_folder), ec);
+
+    return std::filesystem::is_directory(
+        in_workspace(spec.as_file_query().directory, workspace_folder), ec);
+}
+
+// the name other units know a unit by: an architecture goes by its entity
+std::string known_as(vhdl::library_unit_kind kind, const std::string& identifier,
+                     const std::optional<std::string>& identifier2)
+{
+    if (kind == vhdl::library_unit_kind::architecture && identifier2)
+        return identifier2.value();
+    return identifier;
+}
+
+// the files of the units depending on any of the names, directly or not
+std::vector<std::string>
+files_depending_on(vhdl::library_manager& manager, std::set<std::string> names)
+{
+    std::deque<std::string> queue(names.begin(), names.end());
+    std::set<std::string> files;
+
+    auto libraries = manager.list();
+    while (queue.size())
+    {
+        auto name = std::move(queue.front());
+        queue.pop_front();
+
+        for (auto& library : libraries)
+            for (auto& d : manager.get(library)->dependents(name))
+            {
+                files.insert(d.filename);
+                auto next = known_as(d.kind, d.identifier, d.identifier2);
+                if (names.insert(next).second)
+                    queue.push_back(std::move(next));
+            }
+    }
+
+    return {files.begin(), files.end()};
+}
+
+}
+
 bool things::config::file_spec::is_path() const
 {
     return content.index() == 0;
@@ -104,9 +241,21 @@ things::filelist::entry* things::filelist::get_entry(std::string name)
     return entry->second;
 }
 
-things::project::project(std::function<void()> cb, things::client* c)
+void things::filelist::remove_entry(std::string name)
+{
+    std::lock_guard guard(mtx_);
+    if (path_to_entries.erase(name))
+        total_number_of_files--;
+}
+
+things::project::project(
+    std::function<void()> cb, things::client* c,
+    std::function<void(std::string, std::vector<std::string>)> changed)
     : project_folder_(std::filesystem::current_path()), client_(c),
-      loaded_version_(0), on_all_requests_completed(cb)
+      loaded_version_(0), on_all_requests_completed(cb),
+      on_file_changed_on_disk(changed),
+      watcher_(std::bind(&things::project::reindex, this,
+                         std::placeholders::_1))
 {
     current_filelist_ = std::make_shared<things::filelist>();
 
@@ -119,7 +268,24 @@ things::project::project(std::function<void()> cb, things::client* c)
         loaded_version_, current_filelist_, current_library_manager_,
         current_sv_library_manager_,
         path_to_loaded_yaml_.value_or("").string(),
-        on_all_requests_completed, client_, project_folder_.string());
+        on_all_requests_completed, client_, project_folder_.string(),
+        &scheduler_);
+}
+
+things::scheduler* things::project::get_scheduler()
+{
+    return &scheduler_;
+}
+
+std::shared_ptr<things::compass> things::project::get_exploration_progress()
+{
+    std::lock_guard lock(clm_mtx_);
+    return current_progress_;
+}
+
+bool things::project::is_watching_files()
+{
+    return watcher_.is_running();
 }
 
 void things::project::set_project_folder(std::filesystem::path& folder)
@@ -182,16 +348,6 @@ bool things::project::
 
     auto path_to_yaml = project_folder_ / "vhdl_config.yaml";
     path_to_loaded_yaml_ = path_to_yaml;
-    loaded_version_++;
-
-    auto temp_mgr =
-        std::make_shared<vhdl::library_manager>(std::nullopt, false);
-    auto temp_svm = std::make_shared<sv::library_manager>(std::nullopt, false);
-    auto temp_lst = std::make_shared<things::filelist>();
-    auto temp_xpl = std::make_unique<things::explorer>(loaded_version_,
-        temp_lst, temp_mgr, temp_svm,
-        path_to_loaded_yaml_.value_or("").string(),
-        on_all_requests_completed, client_, project_folder_.string());
 
     // ------------------------------------------------------------------------
     // 1) Load the yaml
@@ -251,7 +407,28 @@ bool things::project::
     std::vector<std::string> names_of_all_vhdl_libraries;
     for (auto library: vhdl_config->vhdl)
         names_of_all_vhdl_libraries.push_back(library.name);
-    
+
+    // ------------------------------------------------------------------------
+    // 1.75) Explore again only what changed, if we can
+    // ------------------------------------------------------------------------
+    if (reload_what_changed(vhdl_config, names_of_all_vhdl_libraries))
+    {
+        client_->clear_persistent_diagnostic(path_to_yaml.string());
+        return true;
+    }
+
+    loaded_version_++;
+
+    auto temp_mgr =
+        std::make_shared<vhdl::library_manager>(std::nullopt, false);
+    auto temp_svm = std::make_shared<sv::library_manager>(std::nullopt, false);
+    auto temp_lst = std::make_shared<things::filelist>();
+    auto temp_xpl = std::make_unique<things::explorer>(loaded_version_,
+        temp_lst, temp_mgr, temp_svm,
+        path_to_loaded_yaml_.value_or("").string(),
+        on_all_requests_completed, client_, project_folder_.string(),
+        &scheduler_);
+
     // ------------------------------------------------------------------------
     // 2) Reset project variables
     // ------------------------------------------------------------------------
@@ -259,6 +436,9 @@ bool things::project::
     // if we are here, YAML file had no syntax errors and we have something
     // useful to work with.
 
+    // the watcher goes through the filelist and the libraries about to go
+    watcher_.stop();
+
     // should we wait? I think so
     current_background_explorer_->stop();
     current_background_explorer_->join();
@@ -275,6 +455,10 @@ bool things::project::
     // 3) Kick background indexing
     // ------------------------------------------------------------------------
     current_background_explorer_->start(filelist_specifications);
+    {
+        std::lock_guard lock(clm_mtx_);
+        current_progress_ = current_background_explorer_->get_progress();
+    }
 
     // ------------------------------------------------------------------------
     // 4) Destroy the old library manager
@@ -289,10 +473,253 @@ bool things::project::
     current_sv_library_manager_.reset();
     current_sv_library_manager_ = temp_svm;
 
+    // ------------------------------------------------------------------------
+    // 5) Watch the vhdl files, to index them again as they change
+    // ------------------------------------------------------------------------
+    watch_vhdl_files();
+
     client_->clear_persistent_diagnostic(path_to_yaml.string());
     return true;
 }
 
+bool things::project::reload_what_changed(
+    std::unique_ptr<things::config::root>& config,
+    const std::vector<std::string>& names_of_all_vhdl_libraries)
+{
+    // the libraries are only whole once the explorer is done
+    if (!current_filelist_->vhdl_config || !libraries_have_been_populated())
+        return false;
+
+    // the systemverilog files are only explored again all together
+    auto& loaded = *current_filelist_->vhdl_config;
+    if (!same_specs(loaded.sv, config->sv))
+        return false;
+
+    // ------------------------------------------------------------------------
+    // Match the specs of the new configuration with the loaded ones
+    // ------------------------------------------------------------------------
+    auto workspace_folder = project_folder_.string();
+
+    std::unordered_map<things::config::file_spec*, things::config::file_spec*>
+        kept;
+    for (std::size_t i = 0; i < loaded.sv.files.size(); ++i)
+        kept[&loaded.sv.files[i]] = &config->sv.files[i];
+
+    // A spec whose file or folder is missing found nothing. It is explored
+    // again, so that the diagnostic saying so is sent again
+    things::config::file_specs_ptr added;
+    for (auto& library : config->vhdl)
+        for (auto& spec : library.files)
+        {
+            things::config::file_spec* match = nullptr;
+            for (auto& loaded_library : loaded.vhdl)
+            {
+                if (loaded_library.name != library.name)
+                    continue;
+                for (auto& loaded_spec : loaded_library.files)
+                    if (!match && !kept.count(&loaded_spec) &&
+                        same_content(loaded_spec, spec) &&
+                        can_be_explored(loaded_spec, workspace_folder))
+                        match = &loaded_spec;
+            }
+
+            if (match)
+                kept[match] = &spec;
+            else
+                added.push_back(&spec);
+        }
+
+    std::size_t number_of_loaded_specs = loaded.sv.files.size();
+    std::set<std::string> loaded_libraries;
+    for (auto& library : loaded.vhdl)
+    {
+        number_of_loaded_specs += library.files.size();
+        loaded_libraries.insert(library.name);
+    }
+
+    if (added.empty() && kept.size() == number_of_loaded_specs &&
+        loaded_libraries == std::set<std::string>(
+                                names_of_all_vhdl_libraries.begin(),
+                                names_of_all_vhdl_libraries.end()))
+    {
+        LOG_S(INFO) << "ProjectManager: nothing to explore again in "
+                    << path_to_loaded_yaml_.value_or("").string();
+        return true;
+    }
+
+    watcher_.stop();
+    current_background_explorer_->stop();
+    current_background_explorer_->join();
+    loaded_version_++;
+
+    // ------------------------------------------------------------------------
+    // The files the kept specs found stay, and so does what they hold. What
+    // only the other specs found is forgotten
+    // ------------------------------------------------------------------------
+    auto list = std::make_shared<things::filelist>();
+    for (auto& [path, head] : current_filelist_->path_to_entries)
+    {
+        std::set<std::string> keeping;
+        std::set<std::string> dropping;
+        for (auto entry = head;; entry = entry->next)
+        {
+            auto it = kept.find(entry->spec);
+            if (it != kept.end())
+            {
+                list->add_entry(path, it->second);
+                keeping.insert(entry->spec->library->name);
+            }
+            else
+                dropping.insert(entry->spec->library->name);
+
+            if (entry->next == head)
+                break;
+        }
+
+        // the libraries no longer in the configuration go whole
+        for (auto& name : dropping)
+            if (!keeping.count(name) &&
+                std::find(names_of_all_vhdl_libraries.begin(),
+                          names_of_all_vhdl_libraries.end(),
+                          name) != names_of_all_vhdl_libraries.end())
+            {
+                auto lib = current_library_manager_->get(name);
+                lib->forget_units(path);
+                lib->forget_dependencies(path);
+            }
+    }
+    list->vhdl_config = std::move(config);
+
+    {
+        std::lock_guard lock(clm_mtx_);
+        current_library_manager_->update(names_of_all_vhdl_libraries);
+    }
+
+    current_background_explorer_ = std::make_unique<things::explorer>(
+        loaded_version_, list, current_library_manager_,
+        current_sv_library_manager_,
+        path_to_loaded_yaml_.value_or("").string(),
+        on_all_requests_completed, client_, project_folder_.string(),
+        &scheduler_);
+    current_filelist_ = std::move(list);
+
+    LOG_S(INFO) << "ProjectManager: loaded "
+                << path_to_loaded_yaml_.value_or("").string() << " ver"
+                << loaded_version_ << ", exploring " << added.size()
+                << " file specs again, keeping the files of " << kept.size();
+
+    // the working files are analysed again once the libraries are whole
+    if (added.size())
+    {
+        current_background_explorer_->start(added);
+        std::lock_guard lock(clm_mtx_);
+        current_progress_ = current_background_explorer_->get_progress();
+    }
+    else if (on_all_requests_completed)
+    {
+        on_all_requests_completed();
+    }
+
+    watch_vhdl_files();
+    return true;
+}
+
+void things::project::watch_vhdl_files()
+{
+    std::vector<things::watcher::directory> directories;
+    for (auto& library : current_filelist_->vhdl_config->vhdl)
+        for (auto& file : library.files)
+            directories.push_back(
+                directory_to_watch(file, project_folder_.string()));
+    watcher_.start(directories);
+}
+
+void things::project::reindex(const things::watcher::changes& changes)
+{
+    auto manager = get_current_library_manager();
+    auto workspace_folder = project_folder_.string();
+
+    for (auto& [path, change] : changes)
+    {
+        std::filesystem::path file(path);
+        auto ext = file.extension().string();
+        if (!vhdl::is_a_vhdl_file(ext))
+            continue;
+
+        // the specs finding the file, hence the libraries it is part of
+        std::vector<things::config::file_spec*> specs;
+        for (auto& library : current_filelist_->vhdl_config->vhdl)
+            for (auto& spec : library.files)
+                if (finds(spec, file, workspace_folder))
+                    specs.push_back(&spec);
+        if (specs.empty())
+            continue;
+
+        TRACE_SPAN("reindex", path);
+
+        std::vector<std::tuple<vhdl::library_unit_kind, unsigned, unsigned,
+                               std::string, std::optional<std::string>,
+                               std::string, time_t>>
+            units;
+        std::vector<vhdl::dependency> dependencies;
+        std::ifstream content;
+        if (change == things::watcher::change::written)
+            content.open(file);
+        if (content.is_open() && content.good())
+        {
+            content.seekg(0, std::ios::end);
+            auto size = content.tellg();
+            std::string buffer(size, ' ');
+            content.seekg(0);
+            content.read(&buffer[0], size);
+
+            common::stringtable str;
+            vhdl::fast_parser fast(&str, &buffer[0], &buffer[buffer.length()],
+                                   path);
+            units = fast.parse();
+            dependencies = fast.get_dependencies();
+        }
+
+        // what depends on the units the file held, or holds now, is
+        // out of date
+        std::set<std::string> names;
+        auto is_new = !current_filelist_->get_entry(path);
+        for (auto spec : specs)
+        {
+            auto lib = manager->get(spec->library->name);
+            for (auto& [kind, line, column, identifier, identifier2, filename,
+                        timestamp] : lib->in_file(path))
+                names.insert(known_as(kind, identifier, identifier2));
+
+            lib->forget_units(path);
+            lib->forget_dependencies(path);
+            for (auto& unit : units)
+            {
+                auto& [kind, line, column, identifier, identifier2, filename,
+                       timestamp] = unit;
+                names.insert(known_as(kind, identifier, identifier2));
+                lib->put(unit);
+            }
+            for (auto& d : dependencies)
+                lib->put(d);
+
+            if (is_new && change == things::watcher::change::written)
+                current_filelist_->add_entry(path, spec);
+        }
+
+        // a file which is gone is no longer part of its libraries
+        if (change == things::watcher::change::removed)
+            current_filelist_->remove_entry(path);
+
+        auto dependents = files_depending_on(*manager, std::move(names));
+        LOG_S(INFO) << "ProjectManager: indexed " << path << " again, "
+                    << dependents.size() << " files depend on it";
+
+        if (on_file_changed_on_disk)
+            on_file_changed_on_disk(path, std::move(dependents));
+    }
+}
+
 std::vector<std::string> things::project::get_libraries_this_file_is_part_of(
     std::string& name)
 {
@@ -333,6 +760,7 @@ things::compass::compass(int total, std::function<void()> callback,
     : number_of_files_found(0),
       number_of_requests_completed(0),
       total_number_of_requests(total),
+      started(std::chrono::steady_clock::now()),
       on_all_requests_completed(callback),
       progress_bar(std::move(bar))
 {
@@ -350,6 +778,8 @@ void things::compass::i_just_completed_a_request(int found)
         indexed = number_of_files_found;
         total = total_number_of_requests;
         completed = ++number_of_requests_completed;
+        if (completed == total)
+            finished = std::chrono::steady_clock::now();
     }
     auto p = total == 0 ? 100 : completed * 100 / total;
     auto msg = fmt::format("Found {} files. (Done/Total = {}/{}).",
@@ -374,6 +804,21 @@ int things::compass::get_number_of_files_found()
     return number_of_files_found;
 }
 
+things::compass::bearing things::compass::get_bearing()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::chrono::duration<double> elapsed =
+        finished.value_or(std::chrono::steady_clock::now()) - started;
+
+    bearing b;
+    b.files_found = number_of_files_found;
+    b.requests_completed = number_of_requests_completed;
+    b.total_requests = total_number_of_requests;
+    b.elapsed_s = elapsed.count();
+    return b;
+}
+
 things::explorer::worker::worker(int v, int i,
                                  things::config::file_specs_ptr s,
                                  std::shared_ptr<things::filelist> f,
@@ -381,10 +826,11 @@ things::explorer::worker::worker(int v, int i,
                                  std::shared_ptr<sv::library_manager> svm,
                                  std::shared_ptr<things::compass> p,
                                  std::string y, things::client* c ,
-                                 std::string w)
+                                 std::string w, things::scheduler* sch)
     : busy_(false), quit_(false), done_(false), specs(s), manager(m),
       sv_manager(svm), filelist(f), progress(p),
-      client_(c), workspace_folder(w), version(v), id(i), path_to_yaml(y)
+      client_(c), workspace_folder(w), scheduler_(sch), version(v), id(i),
+      path_to_yaml(y)
 {
     header = fmt::format("Worker{}.{}: ", version, i);
 }
@@ -477,6 +923,11 @@ int things::explorer::worker::explore_spec(things::config::file_spec* spec)
                 {
                     lib->put(e);
                 }
+                lib->forget_dependencies(file.string());
+                for (auto& d : fast.get_dependencies())
+                {
+                    lib->put(d);
+                }
                 ++found;
 
                 filelist->add_entry(file.string(), spec);
@@ -497,6 +948,8 @@ int things::explorer::worker::explore_spec(things::config::file_spec* spec)
             auto is_stopped = quit_.load(std::memory_order_relaxed);
             if (is_stopped)
                 break;
+
+            scheduler_->yield();
         }
     }
     else if (spec->is_path())
@@ -565,6 +1018,11 @@ int things::explorer::worker::explore_spec(things::config::file_spec* spec)
             {
                 lib->put(e);
             }
+            lib->forget_dependencies(file.string());
+            for (auto& d : fast.get_dependencies())
+            {
+                lib->put(d);
+            }
             ++found;
 
             filelist->add_entry(file.string(), spec);
@@ -595,12 +1053,16 @@ void things::explorer::worker::work()
 
     LOG_S(INFO) << header << "handling " << specs.size() << " requests";
 
+    scheduler_->background_started();
+
     for (auto spec: specs)
     {
         auto is_stopped = quit_.load(std::memory_order_relaxed);
         if (is_stopped)
             break;
 
+        scheduler_->yield();
+
         busy_.store(true, std::memory_order_relaxed);
 
         try
@@ -618,6 +1080,15 @@ void things::explorer::worker::work()
         busy_.store(false, std::memory_order_relaxed);
     }
 
+    scheduler_->background_finished();
+
+    auto latency = scheduler_->get_interactive_latency();
+    if (latency.count)
+        LOG_S(INFO) << header
+                    << fmt::format("interactive latency while busy: p50 "
+                                   "{:.1f}ms, p99 {:.1f}ms over {} requests",
+                                   latency.p50, latency.p99, latency.count);
+
     LOG_S(INFO) << header << "done";
     done_.store(true, std::memory_order_relaxed);
 }
@@ -644,10 +1115,10 @@ things::explorer::explorer(int v, std::shared_ptr<things::filelist> f,
                            std::shared_ptr<sv::library_manager> svm,
                            std::string y,
                            std::function<void()> cb, things::client* c,
-                           std::string w)
+                           std::string w, things::scheduler* sch)
     : filelist(f), manager(m), sv_manager(svm),
       path_to_yaml(y), on_all_requests_completed(cb), client_(c),
-      workspace_folder(w), version_(v)
+      workspace_folder(w), scheduler_(sch), version_(v)
 {
     header = fmt::format("Explorer{}: ", version_);
     LOG_S(INFO) << header << "constructed";
@@ -681,7 +1152,7 @@ void things::explorer::start(things::config::file_specs_ptr& q)
     auto length    = number_of_requests / number_of_threads;
     auto remainder = number_of_requests % number_of_threads;
 
-    auto progress = std::make_shared<things::compass>(
+    progress = std::make_shared<things::compass>(
         number_of_requests,
         on_all_requests_completed,
         client_->create_workdone_progress("background"));
@@ -694,7 +1165,7 @@ void things::explorer::start(things::config::file_specs_ptr& q)
         things::config::file_specs_ptr e(q.begin() + begin, q.begin() + end);
         auto w = std::make_unique<worker>(
             version_, i, e, filelist, manager, sv_manager, progress,
-            path_to_yaml, client_, workspace_folder);
+            path_to_yaml, client_, workspace_folder, scheduler_);
 
         std::thread thread(std::bind(&worker::work, w.get()));
         workers.emplace_back(std::move(w));
@@ -719,6 +1190,11 @@ void things::explorer::join()
         ;
 }
 
+std::shared_ptr<things::compass> things::explorer::get_progress()
+{
+    return progress;
+}
+
 bool things::explorer::done()
 {
     auto done = true;
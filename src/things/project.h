@@ -3,6 +3,7 @@
 #define THINGS_PROJECT_H
 
 #include <cassert>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <functional>
@@ -15,6 +16,8 @@
 #include <vector>
 
 #include "client.h"
+#include "scheduler.h"
+#include "watcher.h"
 
 #include "common/diagnostics.h"
 #include "common/loguru.h"
@@ -104,7 +107,10 @@ class project
 {
     public:
 
-    project(std::function<void()>, client*);
+    // the second callback is told about a file which changed on disk, and
+    // the files depending on it. It is called from the thread of the watcher
+    project(std::function<void()>, client*,
+            std::function<void(std::string, std::vector<std::string>)>);
     project(const project&) = delete;
     project(project&&) = delete;
     project& operator=(const project&) = delete;
@@ -141,11 +147,25 @@ class project
     // get the list of include directories needed for this file
     std::vector<std::string> get_incdirs_this_file_needs(std::string&);
 
+    // orders interactive requests and background work across threads
+    things::scheduler* get_scheduler();
+
+    // how far the current background exploration has got. Can be called from
+    // any thread. Returns nullptr if no exploration was started
+    std::shared_ptr<things::compass> get_exploration_progress();
+
+    // returns true if the vhdl files of the project are watched on disk, so
+    // that a file changing does not need the project to be reloaded
+    bool is_watching_files();
+
     private:
     std::filesystem::path project_folder_;
 
     std::optional<std::filesystem::path> path_to_loaded_yaml_;
 
+    // declared before the explorer, whose workers use it until they are done
+    things::scheduler scheduler_;
+
     // I dont think the filelist need to be protected by a mutex. Only the main
     // thread ever uses this. Ditto for the explorer.
     std::unique_ptr<things::explorer> current_background_explorer_;
@@ -154,12 +174,30 @@ class project
     std::mutex clm_mtx_;
     std::shared_ptr<vhdl::library_manager> current_library_manager_;
     std::shared_ptr<sv::library_manager> current_sv_library_manager_;
+    std::shared_ptr<things::compass> current_progress_;
 
     std::function<void()> on_all_requests_completed;
     things::client* client_;
 
     std::atomic_int loaded_version_;
 
+    // Explore again only the file specs which were added or changed since the
+    // configuration was loaded, keeping the libraries and what the other specs
+    // found. Returns false, leaving the configuration alone, when the project
+    // must be reloaded from nothing instead
+    bool reload_what_changed(std::unique_ptr<things::config::root>&,
+                             const std::vector<std::string>&);
+    void watch_vhdl_files();
+
+    // Index again a file which changed on disk, rather than the whole project,
+    // then tell about it, and about the files depending on it
+    void reindex(const things::watcher::changes&);
+    std::function<void(std::string, std::vector<std::string>)>
+        on_file_changed_on_disk;
+
+    // declared last so that it is stopped first, as it uses everything above
+    things::watcher watcher_;
+
     friend explorer;
 };
 
@@ -188,6 +226,10 @@ class filelist
     void add_entry(std::string, things::config::file_spec*);
     entry* get_entry(std::string);
 
+    // forget a file which is gone. Its entries stay allocated, so that an
+    // entry looked up before stays valid
+    void remove_entry(std::string);
+
     std::mutex mtx_;
     std::vector<std::unique_ptr<entry>> entries;
     std::unordered_map<std::string, entry*> path_to_entries;
@@ -208,6 +250,8 @@ class compass
     unsigned number_of_files_found;
     unsigned number_of_requests_completed;
     const unsigned total_number_of_requests;
+    const std::chrono::steady_clock::time_point started;
+    std::optional<std::chrono::steady_clock::time_point> finished;
 
     std::function<void()> on_all_requests_completed;
     std::optional<things::workdone_progress_bar> progress_bar;
@@ -219,6 +263,16 @@ class compass
     void i_just_completed_a_request(int found);
 
     int get_number_of_files_found();
+
+    struct bearing
+    {
+        unsigned files_found = 0;
+        unsigned requests_completed = 0;
+        unsigned total_requests = 0;
+        double elapsed_s = 0; // until all requests completed, or until now
+    };
+
+    bearing get_bearing();
 };
 
 // this is the background project explorer. Give it a list of files (or specs
@@ -237,7 +291,7 @@ class explorer
                std::shared_ptr<vhdl::library_manager>,
                std::shared_ptr<sv::library_manager>,
                std::shared_ptr<compass>,
-               std::string, client*, std::string);
+               std::string, client*, std::string, things::scheduler*);
 
         // worker is not movable not copyable
         worker(const worker&) = delete;
@@ -280,6 +334,7 @@ class explorer
         std::string path_to_yaml;
         client* client_;
         std::string workspace_folder;
+        things::scheduler* scheduler_;
 
     };
 
@@ -289,7 +344,7 @@ class explorer
              std::shared_ptr<vhdl::library_manager>,
              std::shared_ptr<sv::library_manager>,
              std::string, std::function<void()>,
-             things::client*, std::string);
+             things::client*, std::string, things::scheduler*);
     explorer(const explorer&) = delete;
     explorer(explorer&&) = delete;
     explorer& operator=(const explorer&) = delete;
@@ -308,6 +363,9 @@ class explorer
     // return true if background indexing is done.
     bool done();
 
+    // how far the workers have got. nullptr until started
+    std::shared_ptr<things::compass> get_progress();
+
     private:
 
     std::vector<std::unique_ptr<worker>> workers;
@@ -321,6 +379,7 @@ class explorer
     things::language* server_;
     things::client* client_;
     std::string workspace_folder;
+    things::scheduler* scheduler_;
 
     std::function<void()> on_all_requests_completed;
 
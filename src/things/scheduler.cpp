@@ -0,0 +1,97 @@
+
+#include "scheduler.h"
+
+#include <algorithm>
+
+void things::scheduler::interactive_queued()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++interactive_;
+}
+
+void things::scheduler::interactive_done(
+    std::chrono::steady_clock::duration elapsed)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (background_ > 0)
+    {
+        auto ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        if (samples_.size() < max_samples)
+            samples_.push_back(ms);
+        else
+            samples_[next_sample_] = ms;
+        next_sample_ = (next_sample_ + 1) % max_samples;
+    }
+
+    if (--interactive_ == 0)
+        cv_.notify_all();
+}
+
+void things::scheduler::interactive_cancelled()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--interactive_ == 0)
+        cv_.notify_all();
+}
+
+void things::scheduler::background_started()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++background_;
+}
+
+void things::scheduler::background_finished()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    --background_;
+}
+
+void things::scheduler::yield()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait_for(lock, max_yield, [this]() { return interactive_ == 0; });
+}
+
+bool things::scheduler::should_yield(
+    std::chrono::steady_clock::time_point since) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interactive_ > 0 &&
+           std::chrono::steady_clock::now() - since < max_yield;
+}
+
+bool things::scheduler::is_busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return background_ > 0;
+}
+
+bool things::scheduler::is_idle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interactive_ == 0 && background_ == 0;
+}
+
+things::scheduler::latency things::scheduler::get_interactive_latency() const
+{
+    std::vector<double> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples = samples_;
+    }
+
+    latency result;
+    result.count = samples.size();
+    if (samples.empty())
+        return result;
+
+    auto percentile = [&samples](double p) {
+        auto n = static_cast<std::size_t>(p * (samples.size() - 1) + 0.5);
+        std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+        return samples[n];
+    };
+    result.p50 = percentile(0.50);
+    result.p99 = percentile(0.99);
+    return result;
+}
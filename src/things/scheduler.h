@@ -0,0 +1,82 @@
+
+#ifndef THINGS_SCHEDULER_H
+#define THINGS_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace things
+{
+
+// Requests the user is waiting on (hover, definition, document symbols,
+// folding ranges, opening a file) are interactive. Indexing and re-analysing
+// files after indexing or after a save are background work.
+enum class priority { interactive, background };
+
+// Every working file runs its tasks on its own thread, and the explorer has
+// threads of its own. Nothing stops background work from competing with a
+// hover for the cores, so the scheduler orders them.
+//
+// Interactive tasks are registered from the moment they are queued until they
+// are done. Background work calls yield() between units of work (a file to
+// index, a task to run) and is held back while interactive tasks are pending.
+//
+// The latency of interactive tasks completed while background work is running
+// is recorded, to be reported as percentiles.
+class scheduler
+{
+    public:
+    static constexpr std::size_t max_samples = 1024;
+
+    // the longest yield() holds background work back. An interactive task may
+    // be queued behind the very task that is yielding
+    static constexpr std::chrono::milliseconds max_yield{250};
+
+    void interactive_queued();
+    void interactive_done(std::chrono::steady_clock::duration);
+    void interactive_cancelled();
+
+    void background_started();
+    void background_finished();
+
+    // Hold back background work while interactive tasks are pending
+    void yield();
+
+    // Whether background work held back since the given time should keep
+    // waiting. For threads that have other things to do than wait in yield()
+    bool should_yield(std::chrono::steady_clock::time_point since) const;
+
+    bool is_busy() const;
+
+    // No interactive task pending and no background work running, eg for
+    // speculative work
+    bool is_idle() const;
+
+    // latency of interactive tasks while background work was running, in
+    // milliseconds, over the last max_samples tasks
+    struct latency
+    {
+        std::size_t count = 0;
+        double p50 = 0;
+        double p99 = 0;
+    };
+
+    latency get_interactive_latency() const;
+
+    private:
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+
+    int interactive_ = 0;
+    int background_ = 0;
+
+    std::vector<double> samples_;
+    std::size_t next_sample_ = 0;
+};
+
+}
+
+#endif
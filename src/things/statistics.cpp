@@ -0,0 +1,242 @@
+
+#include "statistics.h"
+
+#if !WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "common/histogram.h"
+#include "common/loguru.h"
+#include "common/stringtable.h"
+#include "sv/ast.h"
+#include "vhdl/ast.h"
+#include "vhdl/library_manager.h"
+
+#include "project.h"
+#include "working_files.h"
+
+namespace
+{
+
+using writer = rapidjson::Writer<rapidjson::StringBuffer>;
+
+void write_histogram(writer& w, const common::histogram::snapshot& s)
+{
+    w.StartObject();
+    w.Key("count");    w.Uint64(s.count);
+    w.Key("total_ms"); w.Double(s.total_ms);
+    w.Key("max_ms");   w.Double(s.max_ms);
+    w.Key("p50_ms");   w.Double(s.percentile(0.50));
+    w.Key("p90_ms");   w.Double(s.percentile(0.90));
+    w.Key("p99_ms");   w.Double(s.percentile(0.99));
+
+    // only the buckets holding something, as [upper bound in ms, count]
+    w.Key("buckets");
+        w.StartArray();
+        for (std::size_t i = 0; i < s.buckets.size(); ++i)
+        {
+            if (s.buckets[i] == 0)
+                continue;
+            w.StartArray();
+            w.Double(common::histogram::upper_bound_ms(i));
+            w.Uint64(s.buckets[i]);
+            w.EndArray();
+        }
+        w.EndArray();
+    w.EndObject();
+}
+
+#if !WIN32
+// the write end of the pipe the SIGUSR1 handler writes to
+std::atomic<int> signal_pipe = -1;
+struct sigaction previous_action;
+
+void on_sigusr1(int)
+{
+    auto fd = signal_pipe.load();
+    if (fd < 0)
+        return;
+
+    char c = 's';
+    [[maybe_unused]] auto n = ::write(fd, &c, 1);
+}
+#endif
+
+}
+
+things::statistics::statistics(lsp::frontend* f, things::project* p,
+                               things::working_files* wf)
+: frontend_(f), project_(p), working_files_(wf)
+{
+}
+
+things::statistics::~statistics()
+{
+#if !WIN32
+    if (!watcher_.joinable())
+        return;
+
+    sigaction(SIGUSR1, &previous_action, nullptr);
+    signal_pipe.store(-1);
+
+    char c = 'q';
+    [[maybe_unused]] auto n = ::write(pipe_[1], &c, 1);
+    watcher_.join();
+
+    close(pipe_[0]);
+    close(pipe_[1]);
+#endif
+}
+
+void things::statistics::log_on_signal()
+{
+#if !WIN32
+    if (watcher_.joinable() || signal_pipe.load() >= 0)
+        return;
+
+    if (pipe(pipe_) != 0)
+    {
+        LOG_S(ERROR) << "Statistics: unable to create a pipe for SIGUSR1";
+        return;
+    }
+
+    // the signal handler must never block, even if nobody reads the pipe
+    fcntl(pipe_[1], F_SETFL, fcntl(pipe_[1], F_GETFL) | O_NONBLOCK);
+
+    watcher_ = std::thread([this]() {
+        loguru::set_thread_name("statistics");
+
+        char c;
+        while (::read(pipe_[0], &c, 1) == 1 && c != 'q')
+            LOG_S(INFO) << "Statistics: " << to_json();
+    });
+
+    signal_pipe.store(pipe_[1]);
+
+    struct sigaction action = {};
+    action.sa_handler = on_sigusr1;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, &previous_action);
+#endif
+}
+
+json::string things::statistics::to_json()
+{
+    rapidjson::StringBuffer sb;
+    writer w(sb);
+
+    w.StartObject();
+
+    auto methods = frontend_->get_method_stats();
+    w.Key("requests");
+        w.StartObject();
+        for (auto& [method, s] : methods)
+        {
+            if (s.latency.count == 0)
+                continue;
+            w.Key(method.c_str());
+            write_histogram(w, s.latency);
+        }
+        w.EndObject();
+    w.Key("notifications");
+        w.StartObject();
+        for (auto& [method, s] : methods)
+        {
+            if (s.notifications == 0)
+                continue;
+            w.Key(method.c_str());
+            w.Uint64(s.notifications);
+        }
+        w.EndObject();
+
+    auto outgoing = frontend_->get_outgoing_stats();
+    w.Key("outgoing");
+        w.StartObject();
+        w.Key("depth");     w.Uint64(outgoing.depth);
+        w.Key("max_depth"); w.Uint64(outgoing.max_depth);
+        w.Key("written");   w.Uint64(outgoing.written);
+        w.Key("coalesced"); w.Uint64(outgoing.coalesced);
+        w.EndObject();
+
+    auto scheduler = project_->get_scheduler();
+    auto latency = scheduler->get_interactive_latency();
+    w.Key("scheduler");
+        w.StartObject();
+        w.Key("busy"); w.Bool(scheduler->is_busy());
+        w.Key("interactive_latency");
+            w.StartObject();
+            w.Key("count");  w.Uint64(latency.count);
+            w.Key("p50_ms"); w.Double(latency.p50);
+            w.Key("p99_ms"); w.Double(latency.p99);
+            w.EndObject();
+        w.EndObject();
+
+    w.Key("working_files");
+        w.StartObject();
+        w.Key("files");   w.Uint64(working_files_->get_number_of_files());
+        w.Key("threads"); w.Uint(working_files_->get_number_of_threads());
+        w.EndObject();
+
+    auto& vhdl_stats = vhdl::ast::get_statistics();
+    auto hits = vhdl_stats.cache_hits.load();
+    auto misses = vhdl_stats.cache_misses.load();
+    w.Key("vhdl");
+        w.StartObject();
+        w.Key("parse");   write_histogram(w, vhdl_stats.parse.get());
+        w.Key("analyse"); write_histogram(w, vhdl_stats.analyse.get());
+        w.Key("cache_hits");   w.Uint64(hits);
+        w.Key("cache_misses"); w.Uint64(misses);
+        w.Key("cache_hit_rate");
+        w.Double(hits + misses == 0 ? 0 : double(hits) / (hits + misses));
+        w.EndObject();
+
+    auto& sv_stats = sv::ast::get_statistics();
+    w.Key("sv");
+        w.StartObject();
+        w.Key("parse");  write_histogram(w, sv_stats.parse.get());
+        w.Key("update"); write_histogram(w, sv_stats.update.get());
+        w.EndObject();
+
+    auto& library_stats = vhdl::library_backend::get_statistics();
+    w.Key("library");
+        w.StartObject();
+        w.Key("queries"); write_histogram(w, library_stats.queries.get());
+        w.Key("writes");  w.Uint64(library_stats.writes.load());
+        w.EndObject();
+
+    w.Key("explorer");
+    if (auto progress = project_->get_exploration_progress())
+    {
+        auto b = progress->get_bearing();
+        w.StartObject();
+        w.Key("files_found");        w.Uint(b.files_found);
+        w.Key("requests_completed"); w.Uint(b.requests_completed);
+        w.Key("total_requests");     w.Uint(b.total_requests);
+        w.Key("elapsed_s");          w.Double(b.elapsed_s);
+        w.Key("files_per_s");
+        w.Double(b.elapsed_s > 0 ? b.files_found / b.elapsed_s : 0);
+        w.EndObject();
+    }
+    else
+        w.Null();
+
+    w.Key("memory");
+        w.StartObject();
+        w.Key("stringtables_bytes");
+        w.Uint64(common::stringtable::get_allocated_bytes());
+        w.Key("library_index_bytes");
+        w.Int64(vhdl::library_backend::get_memory_used());
+        w.EndObject();
+
+    w.EndObject();
+
+    return json::string(sb.GetString());
+}
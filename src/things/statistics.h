@@ -0,0 +1,51 @@
+
+#ifndef THINGS_STATISTICS_H
+#define THINGS_STATISTICS_H
+
+#include <thread>
+
+#include "common/json.h"
+#include "lsp/frontend.h"
+
+namespace things
+{
+
+// forward declarations
+class project;
+class working_files;
+
+// The counters kept across the language server, gathered into one json
+// object. It answers the vhdlstuff/stats request, and it is written to the
+// log whenever the process receives SIGUSR1.
+//
+// Every counter can be read from any thread, so the statistics can be
+// gathered while the server is busy.
+class statistics
+{
+    public:
+    statistics(lsp::frontend*, things::project*, things::working_files*);
+    statistics(const statistics&) = delete;
+    statistics(statistics&&) = delete;
+    statistics& operator=(const statistics&) = delete;
+    statistics& operator=(statistics&&) = delete;
+    ~statistics();
+
+    json::string to_json();
+
+    // Log the statistics every time the process receives SIGUSR1. The signal
+    // handler only wakes up a thread which does the work. Does nothing on
+    // windows
+    void log_on_signal();
+
+    private:
+    lsp::frontend* frontend_;
+    things::project* project_;
+    things::working_files* working_files_;
+
+    std::thread watcher_;
+    int pipe_[2] = {-1, -1};
+};
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+
+#include "thread_pool.h"
+
+#include <string>
+
+#include "common/loguru.h"
+
+// a strand of a single job. Once the job has run, the strand goes back to
+// the pool for the next one
+class things::thread_pool::one_off: public things::strand,
+                                    public std::enable_shared_from_this<one_off>
+{
+    public:
+    explicit one_off(things::thread_pool* pool) : pool_(pool) {}
+
+    void set(job f) { f_ = std::move(f); }
+
+    result run_one() override
+    {
+        try
+        {
+            f_();
+        }
+        catch (const std::exception& e)
+        {
+            LOG_S(ERROR) << "Caught exception in a pool task: " << e.what();
+        }
+
+        // what the job captured goes now, not when the strand is reused
+        f_ = job();
+        pool_->recycle(shared_from_this());
+        return result::idle;
+    }
+
+    private:
+    things::thread_pool* pool_;
+    job f_;
+};
+
+things::thread_pool::thread_pool(unsigned number_of_threads)
+{
+    for (unsigned i = 0; i < number_of_threads; ++i)
+        queues_.push_back(std::make_unique<queue>());
+
+    for (unsigned i = 0; i < number_of_threads; ++i)
+        threads_.emplace_back(&things::thread_pool::work, this, i);
+}
+
+things::thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    cv_.notify_all();
+
+    for (auto& thread : threads_)
+        if (thread.joinable())
+            thread.join();
+}
+
+void things::thread_pool::submit(std::shared_ptr<things::strand> s)
+{
+    push(next_queue_++ % queues_.size(), std::move(s));
+}
+
+void things::thread_pool::post(job f)
+{
+    std::shared_ptr<one_off> s;
+    {
+        std::lock_guard<std::mutex> lock(mutex_to_one_offs_);
+        if (!one_offs_.empty())
+        {
+            s = std::move(one_offs_.back());
+            one_offs_.pop_back();
+        }
+    }
+
+    if (!s)
+        s = std::make_shared<one_off>(this);
+    s->set(std::move(f));
+    submit(std::move(s));
+}
+
+void things::thread_pool::recycle(std::shared_ptr<one_off> s)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_one_offs_);
+    one_offs_.push_back(std::move(s));
+}
+
+void things::thread_pool::push(unsigned index, std::shared_ptr<things::strand> s)
+{
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->strands.push_back(std::move(s));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pending_;
+    }
+    cv_.notify_one();
+}
+
+std::shared_ptr<things::strand> things::thread_pool::pop(unsigned index)
+{
+    std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+
+    auto& strands = queues_[index]->strands;
+    if (strands.empty())
+        return nullptr;
+
+    auto s = std::move(strands.front());
+    strands.pop_front();
+    return s;
+}
+
+std::shared_ptr<things::strand> things::thread_pool::steal(unsigned index)
+{
+    for (unsigned i = 1; i < queues_.size(); ++i)
+    {
+        auto& victim = *queues_[(index + i) % queues_.size()];
+
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.strands.empty())
+            continue;
+
+        auto s = std::move(victim.strands.back());
+        victim.strands.pop_back();
+        return s;
+    }
+
+    return nullptr;
+}
+
+void things::thread_pool::work(unsigned index)
+{
+    auto thread_name = "pool thread " + std::to_string(index);
+    loguru::set_thread_name(thread_name.c_str());
+
+    while (true)
+    {
+        for (auto& it : take_due_strands())
+            push(index, std::move(it));
+
+        auto s = pop(index);
+        if (!s)
+            s = steal(index);
+
+        if (!s)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto has_work = [this]() { return stopped_ || pending_ > 0; };
+            if (deferred_.empty())
+                cv_.wait(lock, has_work);
+            else
+                cv_.wait_until(lock, deferred_.front().first, has_work);
+
+            if (stopped_)
+                return;
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --pending_;
+        }
+
+        switch (s->run_one())
+        {
+        case things::strand::result::more:
+            push(index, std::move(s));
+            break;
+
+        case things::strand::result::deferred:
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            deferred_.emplace_back(clock::now() + retry_period, std::move(s));
+        }   break;
+
+        case things::strand::result::idle:
+            break;
+        }
+    }
+}
+
+std::vector<std::shared_ptr<things::strand>>
+things::thread_pool::take_due_strands()
+{
+    std::vector<std::shared_ptr<things::strand>> due;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = clock::now();
+    while (!deferred_.empty() && deferred_.front().first <= now)
+    {
+        due.push_back(std::move(deferred_.front().second));
+        deferred_.pop_front();
+    }
+
+    return due;
+}
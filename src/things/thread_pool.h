@@ -0,0 +1,113 @@
+
+#ifndef THINGS_THREAD_POOL_H
+#define THINGS_THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/inplace_function.h"
+
+namespace things
+{
+
+// A strand is a queue of tasks that must run one after the other, eg the
+// tasks of a working file. The pool runs one task of a strand at a time and
+// never runs a strand on two threads at once.
+class strand
+{
+    public:
+    enum class result
+    {
+        idle,     // the strand has no more tasks
+        more,     // the strand has more tasks, run it again
+        deferred, // the next task must wait, try again a little later
+    };
+
+    virtual ~strand() = default;
+
+    // Run the next task of the strand
+    virtual result run_one() = 0;
+};
+
+// A fixed number of threads running strands. Each thread has its own queue
+// of strands. It takes work from the front of its queue, and when it runs out
+// it steals from the back of the queues of the other threads. A strand with
+// more work to do goes back at the end of the queue of the thread that ran
+// it, so that strands take turns.
+//
+// A strand that is deferred is queued again once retry_period has passed,
+// whether or not the threads have something else to do.
+class thread_pool
+{
+    public:
+    static constexpr std::chrono::milliseconds retry_period{10};
+
+    explicit thread_pool(unsigned number_of_threads);
+    thread_pool(const thread_pool&) = delete;
+    thread_pool(thread_pool&&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    thread_pool& operator=(thread_pool&&) = delete;
+    ~thread_pool();
+
+    // Queue a strand which has tasks to run. The strand must not be queued
+    // already
+    void submit(std::shared_ptr<things::strand>);
+
+    // What post() runs. It captures little more than a request and what it
+    // reads, and is stored inline rather than on the heap
+    using job = common::inplace_function<void(), 128>;
+
+    // Run a job which needs no strand of its own, eg a request which only
+    // reads something immutable. The strands running jobs are recycled, so
+    // posting does not allocate once the pool has warmed up
+    void post(job);
+
+    unsigned size() const { return threads_.size(); }
+
+    private:
+    class one_off;
+
+    struct queue
+    {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<things::strand>> strands;
+    };
+
+    void work(unsigned);
+    std::vector<std::shared_ptr<things::strand>> take_due_strands();
+    void push(unsigned, std::shared_ptr<things::strand>);
+    std::shared_ptr<things::strand> pop(unsigned);
+    std::shared_ptr<things::strand> steal(unsigned);
+
+    std::vector<std::unique_ptr<queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic_uint next_queue_ = 0;
+
+    // protects pending_, deferred_ and stopped_, and is what idle threads
+    // wait on
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t pending_ = 0;
+    bool stopped_ = false;
+
+    // deferred strands and when to queue them again. They are deferred for
+    // the same period, so the first one is always the next one due
+    using clock = std::chrono::steady_clock;
+    std::deque<std::pair<clock::time_point, std::shared_ptr<things::strand>>>
+        deferred_;
+
+    // the strands of the jobs which are done, ready for the next ones
+    std::mutex mutex_to_one_offs_;
+    std::vector<std::shared_ptr<one_off>> one_offs_;
+    void recycle(std::shared_ptr<one_off>);
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+
+#include "watcher.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+#include "common/loguru.h"
+
+namespace
+{
+
+#ifdef __linux__
+constexpr std::uint32_t events = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+
+// the changes are handed over once the directories have been quiet this long,
+// or once the first of them has waited the longest
+constexpr auto quiet = std::chrono::milliseconds(100);
+constexpr auto longest = std::chrono::seconds(1);
+
+}
+
+things::watcher::watcher(std::function<void(changes)> callback)
+: callback_(std::move(callback))
+{
+}
+
+things::watcher::~watcher()
+{
+    stop();
+}
+
+bool things::watcher::start(const std::vector<directory>& directories)
+{
+    stop();
+
+#ifdef __linux__
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_ < 0)
+    {
+        LOG_S(ERROR) << "Watcher: unable to initialise inotify: "
+                     << std::strerror(errno);
+        return false;
+    }
+
+    if (pipe(pipe_) != 0)
+    {
+        LOG_S(ERROR) << "Watcher: unable to create a pipe";
+        stop();
+        return false;
+    }
+
+    for (auto& d : directories)
+        add_watch(d.path, d.recursive);
+
+    if (watches_.empty())
+    {
+        stop();
+        return false;
+    }
+
+    LOG_S(INFO) << "Watcher: watching " << watches_.size() << " directories";
+    thread_ = std::thread(&things::watcher::work, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void things::watcher::stop()
+{
+#ifdef __linux__
+    if (thread_.joinable())
+    {
+        char c = 'q';
+        [[maybe_unused]] auto n = ::write(pipe_[1], &c, 1);
+        thread_.join();
+    }
+
+    for (auto fd : {inotify_, pipe_[0], pipe_[1]})
+        if (fd >= 0)
+            close(fd);
+
+    inotify_ = -1;
+    pipe_[0] = pipe_[1] = -1;
+    watches_.clear();
+#endif
+}
+
+bool things::watcher::is_running() const
+{
+    return thread_.joinable();
+}
+
+void things::watcher::add_watch(const std::string& path, bool recursive)
+{
+#ifdef __linux__
+    auto wd = inotify_add_watch(inotify_, path.c_str(), events);
+    if (wd < 0)
+    {
+        // ENOSPC means that fs.inotify.max_user_watches was reached
+        LOG_S(WARNING) << "Watcher: unable to watch " << path << ": "
+                       << std::strerror(errno);
+        return;
+    }
+    watches_[wd] = directory{path, recursive};
+
+    if (!recursive)
+        return;
+
+    // symbolic links are not followed, as the explorer does not follow them
+    std::error_code ec;
+    for (auto& entry : std::filesystem::directory_iterator(path, ec))
+        if (entry.is_directory(ec) && !entry.is_symlink(ec))
+            add_watch(entry.path().string(), true);
+#endif
+}
+
+void things::watcher::work()
+{
+#ifdef __linux__
+    loguru::set_thread_name("watcher");
+
+    // the last change of each file wins
+    std::map<std::string, change> pending;
+    std::chrono::steady_clock::time_point pending_since;
+
+    auto hand_over = [&]() {
+        changes c(pending.begin(), pending.end());
+        pending.clear();
+        try
+        {
+            callback_(std::move(c));
+        }
+        catch (const std::exception& e)
+        {
+            LOG_S(ERROR) << "Watcher: caught exception: " << e.what();
+        }
+    };
+
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        pollfd fds[2] = {{inotify_, POLLIN, 0}, {pipe_[0], POLLIN, 0}};
+        auto n = poll(fds, 2, pending.empty() ? -1 : int(quiet.count()));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            LOG_S(ERROR) << "Watcher: poll failed: " << std::strerror(errno);
+            return;
+        }
+        if (fds[1].revents)
+            return;
+
+        if (n == 0)
+        {
+            hand_over();
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = ::read(inotify_, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* p = buffer; p < buffer + length;)
+            {
+                auto event = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    LOG_S(WARNING) << "Watcher: the kernel dropped events, "
+                                      "some changes went unnoticed";
+                    continue;
+                }
+
+                auto it = watches_.find(event->wd);
+                if (it == watches_.end())
+                    continue;
+
+                // the directory was removed
+                if (event->mask & IN_IGNORED)
+                {
+                    watches_.erase(it);
+                    continue;
+                }
+
+                if (event->len == 0)
+                    continue;
+
+                auto path =
+                    (std::filesystem::path(it->second.path) / event->name)
+                        .string();
+
+                if (pending.empty())
+                    pending_since = std::chrono::steady_clock::now();
+
+                if (event->mask & IN_ISDIR)
+                {
+                    // a new directory is watched too, and what it already
+                    // holds was written
+                    if (!it->second.recursive ||
+                        !(event->mask & (IN_CREATE | IN_MOVED_TO)))
+                        continue;
+
+                    add_watch(path, true);
+
+                    std::error_code ec;
+                    for (auto& entry :
+                         std::filesystem::recursive_directory_iterator(path, ec))
+                        if (entry.is_regular_file(ec))
+                            pending[entry.path().string()] = change::written;
+                    continue;
+                }
+
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                    pending[path] = change::removed;
+                else
+                    pending[path] = change::written;
+            }
+        }
+
+        if (!pending.empty() &&
+            std::chrono::steady_clock::now() - pending_since >= longest)
+            hand_over();
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+
+#ifndef THINGS_WATCHER_H
+#define THINGS_WATCHER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace things
+{
+
+// Watches directories for files being written, created or removed, and hands
+// the changes to a callback on a thread of its own. The changes are gathered
+// until the directories have been quiet for a moment, so that an editor which
+// saves a file in several steps only makes for one change.
+//
+// Linux only, through inotify. Elsewhere start() returns false and nothing is
+// watched.
+class watcher
+{
+    public:
+    enum class change
+    {
+        written, // created, written, or moved into a watched directory
+        removed  // removed, or moved out of a watched directory
+    };
+
+    struct directory
+    {
+        std::string path;
+        bool recursive;
+    };
+
+    using changes = std::vector<std::pair<std::string, change>>;
+
+    explicit watcher(std::function<void(changes)>);
+    watcher(const watcher&) = delete;
+    watcher(watcher&&) = delete;
+    watcher& operator=(const watcher&) = delete;
+    watcher& operator=(watcher&&) = delete;
+    ~watcher();
+
+    // Watch these directories instead of whatever was watched before. Returns
+    // false if nothing can be watched
+    bool start(const std::vector<directory>&);
+
+    // stop watching, and wait for the callback to return
+    void stop();
+
+    bool is_running() const;
+
+    private:
+    void add_watch(const std::string&, bool);
+    void work();
+
+    std::function<void(changes)> callback_;
+
+    std::thread thread_;
+    int inotify_ = -1;
+    int pipe_[2] = {-1, -1};
+
+    // the watched directory of each watch descriptor. Only the thread of the
+    // watcher uses it once started
+    std::unordered_map<int, directory> watches_;
+};
+
+}
+
+#endif
@@ -7,12 +7,70 @@
 #include "slang/diagnostics/DiagnosticEngine.h"
 
 #include "common/scope_guard.h"
+#include "common/trace.h"
 
 #include "definition_provider.h"
 #include "document_symbol_provider.h"
 #include "folding_range_provider.h"
 #include "hover_provider.h"
 
+#include <algorithm>
+#include <variant>
+
+namespace
+{
+
+// Hover and definition only care about the node under the cursor. Look it up
+// in the position index and traverse that node alone, instead of the whole
+// design file. Positions outside of any design unit (eg context clauses) fall
+// back to traversing the whole file
+template <typename V>
+void traverse_at(const vhdl::ast::snapshot& s, common::position pos, V& v)
+{
+    auto at = s.positions.find(pos);
+    if (!at)
+    {
+        s.main_file->traverse_static(v);
+        return;
+    }
+
+    std::visit([&v](auto* n) { n->traverse_static(v); }, at->syntax);
+}
+
+// slang formats its diagnostics as they are reported. What is left to save is
+// sending them
+std::uint64_t fingerprint(const std::vector<lsp::diagnostic>& diags)
+{
+    common::fingerprint_builder h;
+    auto mix_range = [&h](const lsp::range& r) {
+        h.mix(r.start.line);
+        h.mix(r.start.character);
+        h.mix(r.end.line);
+        h.mix(r.end.character);
+    };
+
+    h.mix(diags.size());
+    for (auto& d : diags)
+    {
+        mix_range(d.range);
+        h.mix(d.severity);
+        h.mix(d.code);
+        h.mix(d.source.value_or(""));
+        h.mix(d.message);
+
+        h.mix(d.related_information.size());
+        for (auto& info : d.related_information)
+        {
+            h.mix(info.location.uri.get_uri());
+            mix_range(info.location.range);
+            h.mix(info.message);
+        }
+    }
+    return h.get();
+}
+
+}
+
 things::working_file::working_file(std::string file, things::client* client,
                                    things::project* prj)
     : file_(file), policy(run_on_main_thread), client_(client), project_(prj),
@@ -20,77 +78,255 @@ things::working_file::working_file(std::string file, things::client* client,
 {
 }
 
-things::working_file::~working_file()
-{
-    if (thread.joinable())
-        // Should we detach or should we join here?
-        //
-        // I think we should detach. But valgrind occasionally reports an error
-        // with pthreads. I think it's got to do with the actual thread running
-        // beyond main, and valgrind complaining about a false positive. Even
-        // with the many primitives (mutex_, conditional_variable_ etc...) that
-        // ensures no threads are running when things::working_files is being
-        // destroyed, we still see the valgrind complaint. Not too sure why.
-        //
-        // So let's join for now. The downside of join is that it causes the
-        // things::working_files::remove() function to block.
-        //
-        // Possible solution to all of this:
-        //
-        // Implement some form of garbage collection.
-        //
-        // 1. In things::working_files::remove(), stop the thread and add the
-        //    working file to the garbage bin.
-        // 2. To ensure the trash can does not perpetually grow in size, every
-        //    so often, we will check it, and throw away the files whose thread
-        //    havs finally joined.
-        // 3. When things::working_files is being destroyed, all the garbage
-        //    will be passed onto the main thread, who will then check and
-        //    throw the trash away.
-        thread.detach();
-}
-
 void things::working_file::invalidate_potentially_referenced_file(std::string f)
 {
     std::unique_lock<std::mutex> lock(mutex_to_invalidate_files_);
     list_of_potentially_referenced_files_now_invalid.push_back(f);
 }
 
-void things::working_file::forever_loop()
+things::strand::result things::working_file::run_one()
 {
-    while (true)
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopped_.load() || queue_.empty())
     {
-        try
-        {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [&]() { return !queue_.empty() || stopped_.load(); });
-            if (stopped_.load())
-                break;
-            auto request = queue_.front();
-            queue_.pop_front();
+        cancel_queued_tasks();
+        scheduled_ = false;
+        return result::idle;
+    }
+
+    // a debounced task waits in case another change supersedes it
+    auto& front = queue_.front();
+    if (!front.is_superseded && front.not_before &&
+        std::chrono::steady_clock::now() < *front.not_before)
+        return result::deferred;
 
-            if (request.action)
-                request.action(request.is_superseded);
+    // background work makes way for interactive requests of any file, for a
+    // while. There is nothing to make way for when the task was superseded.
+    // Instead of blocking a thread of the pool, hand it back
+    if (front.priority == things::priority::background && !front.is_superseded)
+    {
+        if (!front.deferred_since)
+            front.deferred_since = std::chrono::steady_clock::now();
+        if (project_->get_scheduler()->should_yield(*front.deferred_since))
+            return result::deferred;
+    }
+
+    auto request = std::move(queue_.front());
+    queue_.pop_front();
+
+    // don't hold the queue while working, so that requests can still be
+    // queued, and supersede this one
+    lock.unlock();
+
+    try
+    {
+        run(request);
+    }
+    catch (const std::exception& e)
+    {
+        LOG_S(ERROR) << "Caught exception while working on " << file_
+                     << ": "
+                     << e.what();
+    }
+
+    lock.lock();
+    if (stopped_.load() || queue_.empty())
+    {
+        cancel_queued_tasks();
+        scheduled_ = false;
+        return result::idle;
+    }
+
+    return result::more;
+}
+
+void things::working_file::run(task& request)
+{
+    auto scheduler = project_->get_scheduler();
+
+    TRACE_COMPLETE("queued", file_, request.request_time,
+                   std::chrono::steady_clock::now());
+    TRACE_SPAN(request.name, file_);
+
+    if (request.priority == things::priority::interactive)
+    {
+        // the latency of a debounced task counts from the end of its delay.
+        // It is negative when the task was superseded before then
+        auto done = common::make_scope_guard([&]() {
+            auto latency =
+                std::chrono::steady_clock::now() - request.request_time;
+            scheduler->interactive_done(
+                std::max(latency, std::chrono::steady_clock::duration::zero()));
+        });
+
+        if (request.action)
+            request.action(request.is_superseded);
+        return;
+    }
+
+    scheduler->background_started();
+    auto finished = common::make_scope_guard([&]() {
+        scheduler->background_finished();
+    });
+
+    if (request.action)
+        request.action(request.is_superseded);
+}
+
+std::size_t things::working_file::get_memory_estimate() const
+{
+    return memory_estimate_.load();
+}
+
+bool things::working_file::evict()
+{
+    // nothing runs on the ast while the file is neither queued nor running
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduled_ || !queue_.empty() || memory_estimate_.load() == 0)
+        return false;
+
+    drop_ast();
+    memory_estimate_.store(0);
+    evicted_.store(true);
+    return true;
+}
+
+bool things::working_file::is_evicted() const
+{
+    return evicted_.load();
+}
+
+void things::working_file::mark_stale()
+{
+    stale_.store(true);
+}
+
+std::optional<int> things::working_file::document_version()
+{
+    std::lock_guard<std::mutex> lock(mutex_to_document_);
+    if (!document_)
+        return std::nullopt;
+    return document_->version();
+}
+
+void things::working_file::snapshot_published(
+    bool published, std::optional<int> text_version)
+{
+    has_snapshot_ = published;
+    snapshot_text_version_ = text_version;
+    snapshot_project_version_ = current_project_version_;
+    snapshot_library_fully_loaded_ = library_fully_loaded_;
+}
+
+bool things::working_file::snapshot_is_current()
+{
+    return policy == run_on_different_thread && has_snapshot_ &&
+           snapshot_project_version_ == project_->get_loaded_version() &&
+           snapshot_library_fully_loaded_ ==
+               project_->libraries_have_been_populated() &&
+           snapshot_text_version_ == document_version();
+}
+
+void things::working_file::post_snapshot_read(
+    common::inplace_function<void()> read)
+{
+    auto scheduler = project_->get_scheduler();
+    scheduler->interactive_queued();
+
+    auto queued = std::chrono::steady_clock::now();
+    pool->post([this, self = shared_from_this(), read = std::move(read),
+                scheduler, queued]() mutable {
+        TRACE_COMPLETE("queued", file_, queued,
+                       std::chrono::steady_clock::now());
+        TRACE_SPAN("snapshot", file_);
+
+        auto done = common::make_scope_guard([&]() {
+            scheduler->interactive_done(std::chrono::steady_clock::now() -
+                                        queued);
+        });
+
+        read();
+    });
+}
+
+bool things::working_file::diagnostics_changed(std::uint64_t fingerprint)
+{
+    if (diagnostics_fingerprint_ == fingerprint)
+        return false;
+
+    diagnostics_fingerprint_ = fingerprint;
+    return true;
+}
+
+void things::working_file::open(std::string_view text, int version)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_document_);
+    document_.emplace(std::string(text), version);
+}
+
+void things::working_file::change(
+    int version,
+    const std::vector<lsp::text_document_content_change_event>& changes)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_document_);
+    for (auto& it : changes)
+    {
+        if (!it.range)
+        {
+            if (document_)
+                document_->replace(it.text, version);
+            else
+                document_.emplace(std::string(it.text), version);
+            continue;
         }
-        catch (const std::exception& e)
+
+        // we never saw the document, there is nothing to apply the change to
+        if (!document_)
         {
-            LOG_S(ERROR) << "Caught exception while working on " << file_
-                         << ": "
-                         << e.what();
+            LOG_S(WARNING) << file_ << ": change to a document never opened";
+            return;
         }
 
+        auto& r = *it.range;
+        if (!document_->replace({r.start.line, r.start.character},
+                                {r.end.line, r.end.character}, it.text,
+                                version))
+            LOG_S(WARNING) << file_ << ": ignoring change with a bad range";
     }
 }
 
+std::optional<std::tuple<std::string, int>>
+things::working_file::document_if_newer(std::optional<int> version)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_document_);
+    if (!document_ || document_->version() == version)
+        return std::nullopt;
+
+    return std::make_tuple(document_->text(), document_->version());
+}
+
+void things::working_file::cancel_queued_tasks()
+{
+    for (auto& entry : queue_)
+        if (entry.priority == things::priority::interactive)
+            project_->get_scheduler()->interactive_cancelled();
+    queue_.clear();
+}
+
 void things::working_file::stop()
 {
     std::unique_lock<std::mutex> lock(mutex_);
     stopped_.store(true);
-    cv_.notify_one();
+
+    // when scheduled, the pool takes care of the queue the next time it runs
+    // this file
+    if (!scheduled_)
+        cancel_queued_tasks();
 }
 
-void things::working_file::add_task(std::string name,
-                                    std::function<void(bool)> task)
+void things::working_file::add_task(std::string name, things::priority p,
+                                    task_function task,
+                                    std::chrono::milliseconds delay)
 {
     if (policy == run_on_main_thread)
     {
@@ -99,105 +335,209 @@ void things::working_file::add_task(std::string name,
     }
     else
     {
-        // invalidate everything on the queue
-        for (auto& entry : queue_)
-            entry.is_superseded = true;
-
         working_file::task request;
         request.name = name;
+        request.priority = p;
+        request.request_time = std::chrono::steady_clock::now() + delay;
         request.action = std::move(task);
+        if (delay.count())
+            request.not_before = request.request_time;
+
+        if (p == things::priority::interactive)
+            project_->get_scheduler()->interactive_queued();
+
         std::unique_lock<std::mutex> lock(mutex_);
-        queue_.push_back(request);
-        cv_.notify_one();
+
+        // invalidate everything on the queue
+        for (auto& entry : queue_)
+            entry.is_superseded = true;
+
+        queue_.push_back(std::move(request));
+
+        if (scheduled_)
+            return;
+        scheduled_ = true;
+        lock.unlock();
+
+        pool->submit(shared_from_this());
     }
 }
 
 
 things::working_files::working_files(things::language* s, things::client* c,
                                      bool j)
-    : number_of_running_threads_(0), server_(s), client_(c),
-      everything_on_main_thread(j)
+    : server_(s), client_(c), everything_on_main_thread(j),
+      pool_(j ? 0 : std::max(2u, std::thread::hardware_concurrency()))
 {
-
+    if (!everything_on_main_thread)
+        prefetcher_ = std::make_shared<things::prefetcher>(&server_->project,
+                                                           &pool_);
 }
 
 things::working_files::~working_files()
 {
+    if (prefetcher_)
+        prefetcher_->stop();
+
     for (auto& it : working_files_)
     {
         it.second->stop();
     }
     working_files_.clear();
 
-    // wait for running threads = 0. Should we add a duration here?
-    std::unique_lock<std::mutex> guard(mutex_);
-    if (number_of_running_threads_ != 0)
-        no_running_threads_.wait(guard);
+    // the pool is destroyed next, and joins its threads once they are done
+    // with the task at hand
 }
 
-bool things::working_files::update(std::string file)
+bool things::working_files::add(const std::string& file)
 {
-    auto new_file = false;
-    if (working_files_.find(file) == working_files_.end())
+    if (working_files_.find(file) != working_files_.end())
+        return false;
+
+    std::filesystem::path path(file);
+    auto ext = path.extension().string();
+
+    std::shared_ptr<working_file> wf;
+    if (sv::is_a_sv_file(ext))
+        wf = std::make_shared<sv_working_file>(file, client_, &server_->project);
+    else if (vhdl::is_a_vhdl_file(ext))
+        wf = std::make_shared<vhdl_working_file>(file, client_, &server_->project);
+    else
+        assert(sv::is_a_sv_file(ext) || vhdl::is_a_vhdl_file(ext));
+
+    // if we want to run_everything_on_the_main_thread, simply create a
+    // working_file object, and simply call its update() function.
+    if (everything_on_main_thread)
     {
-        std::filesystem::path path(file);
-        auto ext = path.extension().string();
-
-        std::shared_ptr<working_file> wf;
-        if (sv::is_a_sv_file(ext))
-            wf = std::make_shared<sv_working_file>(file, client_, &server_->project);
-        else if (vhdl::is_a_vhdl_file(ext))
-            wf = std::make_shared<vhdl_working_file>(file, client_, &server_->project);
-        else
-            assert(sv::is_a_sv_file(ext) || vhdl::is_a_vhdl_file(ext));
+        wf->policy = working_file::run_on_main_thread;
+        std::lock_guard<std::mutex> lock(mutex_to_working_files_);
+        working_files_[file] = std::move(wf);
+    }
+    // However, if we dont mind running on other threads, the file is
+    // run by the pool whenever it has tasks
+    else
+    {
+        wf->policy = working_file::run_on_different_thread;
+        wf->pool = &pool_;
 
-        // if we want to run_everything_on_the_main_thread, simply create a
-        // working_file object, and simply call its update() function.
-        if (everything_on_main_thread)
+        if (auto vhdl = std::dynamic_pointer_cast<vhdl_working_file>(wf))
         {
-            wf->policy = working_file::run_on_main_thread;
-            working_files_[file] = std::move(wf);
-            new_file = true;
+            if (auto prefetched = prefetcher_->open(file))
+                vhdl->adopt(std::move(*prefetched));
+            vhdl->prefetcher = prefetcher_;
         }
-        // However, if we dont mind creating threads, only then we execute all
-        // of the following code
-        else
-        {
-            auto cleanup = common::make_scope_guard([this]() {
-                std::lock_guard<std::mutex> guard(mutex_);
-                auto run_execution_policys = --number_of_running_threads_;
-                if (run_execution_policys == 0)
-                    no_running_threads_.notify_one();
-            });
 
-            wf->thread = std::thread([file, wf, C = std::move(cleanup)]() {
-                loguru::set_thread_name("file thread");
+        std::lock_guard<std::mutex> lock(mutex_to_working_files_);
+        working_files_[file] = std::move(wf);
+    }
 
-                LOG_S(INFO) << file << ": started";
+    number_of_files_ = working_files_.size();
+    return true;
+}
 
-                wf->forever_loop();
+bool things::working_files::open(std::string file, std::string_view text,
+                                 int version)
+{
+    auto new_file = add(file);
+    working_files_[file]->open(text, version);
+    update(file, things::priority::interactive);
+    return new_file;
+}
 
-                LOG_S(INFO) << file << ": done";
-            });
+void things::working_files::set_memory_budget(std::size_t budget)
+{
+    memory_budget_ = budget;
+}
 
-            wf->policy = working_file::run_on_different_thread;
-            working_files_[file] = std::move(wf);
-            new_file = true;
+void things::working_files::set_prefetch_memory_budget(std::size_t budget)
+{
+    if (prefetcher_)
+        prefetcher_->set_memory_budget(budget);
+}
 
-            {
-            std::lock_guard<std::mutex> guard(mutex_);
-            ++number_of_running_threads_;
-            }
+void things::working_files::touch(const std::string& file)
+{
+    auto it = working_files_.find(file);
+    if (it == working_files_.end())
+        return;
+
+    it->second->last_used = ++last_used_;
+    enforce_memory_budget(it->second.get());
+}
+
+void things::working_files::enforce_memory_budget(working_file* in_use)
+{
+    if (memory_budget_ == 0)
+        return;
+
+    std::size_t total = 0;
+    std::vector<working_file*> candidates;
+    for (auto& [name, wf] : working_files_)
+    {
+        auto size = wf->get_memory_estimate();
+        total += size;
+        if (size && wf.get() != in_use)
+            candidates.push_back(wf.get());
+    }
+
+    if (total <= memory_budget_)
+        return;
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](auto lhs, auto rhs) { return lhs->last_used < rhs->last_used; });
+
+    std::size_t evicted = 0;
+    for (auto wf : candidates)
+    {
+        if (total <= memory_budget_)
+            break;
+
+        // files with work queued are busy, hence not the least recently used
+        // in a way that matters. They get their turn next time
+        auto size = wf->get_memory_estimate();
+        if (wf->evict())
+        {
+            total -= size;
+            evicted++;
         }
     }
+
+    if (evicted)
+        LOG_S(INFO) << "Evicted the asts of " << evicted << " working files. "
+                    << "They hold an estimated " << (total >> 20)
+                    << " MiB, for a budget of " << (memory_budget_ >> 20)
+                    << " MiB";
+}
+
+void things::working_files::change(
+    std::string file, int version,
+    const std::vector<lsp::text_document_content_change_event>& changes)
+{
+    auto it = working_files_.find(file);
+    if (it == working_files_.end())
+        return;
+
+    it->second->change(version, changes);
+    it->second->update(things::priority::interactive,
+                       working_file::change_debounce);
+    touch(file);
+}
+
+bool things::working_files::update(std::string file, things::priority p)
+{
+    if (prefetcher_)
+        prefetcher_->invalidate(file);
+
+    auto new_file = add(file);
     for (auto [name, wf] : working_files_)
     {
         if (name == file)
-            wf->update();
+            wf->update(p, std::chrono::milliseconds(0));
         else
             wf->invalidate_potentially_referenced_file(file);
     }
 
+    touch(file);
     return new_file;
 }
 
@@ -207,15 +547,63 @@ void things::working_files::remove(std::string file)
     if (it != working_files_.end())
     {
         it->second->stop();
+        std::lock_guard<std::mutex> lock(mutex_to_working_files_);
         working_files_.erase(it);
+        number_of_files_ = working_files_.size();
     }
+
+    if (prefetcher_)
+        prefetcher_->close(file);
+}
+
+std::size_t things::working_files::get_number_of_files() const
+{
+    return number_of_files_;
+}
+
+unsigned things::working_files::get_number_of_threads() const
+{
+    return pool_.size();
 }
 
 void things::working_files::update_all_files()
 {
+    std::lock_guard<std::mutex> lock(mutex_to_working_files_);
     for (auto [name, wf] : working_files_)
     {
-        wf->update();
+        // evicted files are rebuilt when they are next asked something
+        if (wf->is_evicted())
+        {
+            wf->mark_stale();
+            continue;
+        }
+        wf->update(things::priority::background, std::chrono::milliseconds(0));
+    }
+}
+
+void things::working_files::changed_on_disk(
+    const std::string& file, const std::vector<std::string>& dependents)
+{
+    if (prefetcher_)
+        prefetcher_->invalidate(file);
+
+    std::lock_guard<std::mutex> lock(mutex_to_working_files_);
+    for (auto [name, wf] : working_files_)
+    {
+        if (name != file)
+            wf->invalidate_potentially_referenced_file(file);
+
+        // the others reload it the next time they are analysed
+        if (name != file && std::find(dependents.begin(), dependents.end(),
+                                      name) == dependents.end())
+            continue;
+
+        if (wf->is_evicted())
+        {
+            wf->mark_stale();
+            continue;
+        }
+        wf->update(things::priority::background, std::chrono::milliseconds(0));
     }
 }
 
@@ -227,6 +615,7 @@ void things::working_files::folding_ranges(
 
     auto wf = working_files_.find(file)->second.get();
     wf->folding_ranges(request);
+    touch(file);
 }
 
 void things::working_files::symbols(
@@ -237,6 +626,7 @@ void things::working_files::symbols(
 
     auto wf = working_files_.find(file)->second.get();
     wf->symbols(request);
+    touch(file);
 }
 
 void things::working_files::hover(
@@ -248,6 +638,7 @@ void things::working_files::hover(
 
     auto wf = working_files_.find(file)->second.get();
     wf->hover(request, pos);
+    touch(file);
 }
 
 void things::working_files::definition(
@@ -259,6 +650,7 @@ void things::working_files::definition(
 
     auto wf = working_files_.find(file)->second.get();
     wf->definition(request, pos);
+    touch(file);
 }
 
 things::vhdl_working_file::vhdl_working_file(std::string file,
@@ -268,7 +660,8 @@ things::vhdl_working_file::vhdl_working_file(std::string file,
 {
 }
 
-void things::vhdl_working_file::update()
+void things::vhdl_working_file::update(things::priority p,
+                                       std::chrono::milliseconds delay)
 {
     auto analyse_and_diagnose = [this](bool is_superseded) {
         if (is_superseded)
@@ -288,85 +681,183 @@ void things::vhdl_working_file::update()
             list_of_potentially_referenced_files_now_invalid.clear();
         }
 
+        if (auto document = document_if_newer(ast->get_main_file_text_version()))
+            ast->set_main_file_text(std::move(std::get<0>(*document)),
+                                    std::get<1>(*document));
+
         ast->invalidate_main_file();
         ast->update();
+        memory_estimate_ = ast->get_memory_estimate();
+        publish_snapshot();
 
         send_diagnostics_back_to_client_if_needed();
+        suggest_neighbours();
     };
 
-    return add_task("update", std::move(analyse_and_diagnose));
+    return add_task("update", p, std::move(analyse_and_diagnose), delay);
+}
+
+void things::vhdl_working_file::adopt(things::prefetcher::prefetched p)
+{
+    ast = std::move(p.ast);
+    current_project_version_ = p.project_version;
+    library_fully_loaded_ = true;
+    work_libraries_ = std::move(p.work_libraries);
+}
+
+void things::vhdl_working_file::suggest_neighbours()
+{
+    if (!prefetcher || neighbours_suggested_ || !library_fully_loaded_ ||
+        !ast->get_main_file())
+        return;
+
+    neighbours_suggested_ = true;
+    prefetcher->suggest(
+        ast->get_neighbour_files(things::prefetcher::max_neighbours));
+}
+
+void things::vhdl_working_file::drop_ast()
+{
+    // keep the outline, as replies
+    if (ast)
+    {
+        auto s = ast->get_snapshot();
+        if (s->main_file)
+        {
+            folding_ranges_json(*s);
+            symbols_json(*s);
+        }
+    }
+
+    evicted_text_version_ = ast ? ast->get_main_file_text_version()
+                                : std::nullopt;
+    ast.reset();
+    publish_snapshot();
+}
+
+void things::vhdl_working_file::publish_snapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex_to_snapshot_);
+    snapshot_ast_ = ast;
+    snapshot_ = ast ? ast->get_snapshot() : nullptr;
+    snapshot_published(snapshot_ != nullptr,
+                       snapshot_ ? snapshot_->text_version : std::nullopt);
+}
+
+json::string things::vhdl_working_file::folding_ranges_json(
+    const vhdl::ast::snapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_replies_);
+    auto version = snapshot.main_file_version;
+    if (folding_ranges_.json && folding_ranges_.version == version)
+        return *folding_ranges_.json;
+
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> w(s);
+
+    w.StartArray();
+    vhdl_folding_range_provider d(&w);
+    d(snapshot.outline);
+    w.EndArray();
+
+    folding_ranges_.version = version;
+    folding_ranges_.json = json::string(s.GetString());
+    return *folding_ranges_.json;
+}
+
+json::string things::vhdl_working_file::symbols_json(
+    const vhdl::ast::snapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_replies_);
+    auto version = snapshot.main_file_version;
+    if (symbols_.json && symbols_.version == version)
+        return *symbols_.json;
+
+    rapidjson::StringBuffer s;
+    rapidjson::Writer<rapidjson::StringBuffer> w(s);
+
+    w.StartArray();
+    vhdl_document_symbol_provider d(&w);
+    d(snapshot.outline);
+    w.EndArray();
+
+    symbols_.version = version;
+    symbols_.json = json::string(s.GetString());
+    return *symbols_.json;
+}
+
+json::string things::vhdl_working_file::last_reply(const cached_reply& c)
+{
+    std::lock_guard<std::mutex> lock(mutex_to_replies_);
+    return c.json.value_or(json::string("[]"));
 }
 
 void things::vhdl_working_file::folding_ranges(
     std::shared_ptr<lsp::incoming_request> r)
 {
-    auto calculate_folding_ranges = [r](std::shared_ptr<vhdl::ast> ast) {
-        if (!ast || !ast->get_main_file()) {
-            r->reply(json::string("[]"));
+    auto calculate_folding_ranges = [this, r](const vhdl::ast::snapshot* s) {
+        // superseded or evicted: whatever we computed last is better than
+        // nothing, and up to date when evicted
+        if (!s) {
+            r->reply(last_reply(folding_ranges_));
             return;
         }
 
-        rapidjson::StringBuffer s;
-        rapidjson::Writer<rapidjson::StringBuffer> w(s);
+        if (!s->main_file) {
+            r->reply(json::string("[]"));
+            return;
+        }
 
-        w.StartArray();
-        vhdl_folding_range_provider d(&w);
-        ast->get_main_file()->traverse(d);
-        w.EndArray();
-    
-        json::string json = s.GetString();
-        r->reply(json);
+        r->reply(folding_ranges_json(*s));
     };
-    run_with_vhdl_ast(calculate_folding_ranges);
+    run_with_vhdl_ast(calculate_folding_ranges, true);
 }
 
 void things::vhdl_working_file::symbols(
     std::shared_ptr<lsp::incoming_request> r)
 {
-    auto get_document_symbols = [r](std::shared_ptr<vhdl::ast> ast) {
-        if (!ast || !ast->get_main_file()) {
-            r->reply(json::string("[]"));
+    auto get_document_symbols = [this, r](const vhdl::ast::snapshot* s) {
+        // superseded or evicted: whatever we computed last is better than
+        // nothing, and up to date when evicted
+        if (!s) {
+            r->reply(last_reply(symbols_));
             return;
         }
 
-        rapidjson::StringBuffer s;
-        rapidjson::Writer<rapidjson::StringBuffer> w(s);
+        if (!s->main_file) {
+            r->reply(json::string("[]"));
+            return;
+        }
 
-        w.StartArray();
-        vhdl_document_symbol_provider d(&w);
-        ast->get_main_file()->traverse(d);
-        w.EndArray();
-    
-        json::string json = s.GetString();
-        r->reply(json);
+        r->reply(symbols_json(*s));
     };
 
-    run_with_vhdl_ast(get_document_symbols);
+    run_with_vhdl_ast(get_document_symbols, true);
 }
 
 void things::vhdl_working_file::hover(std::shared_ptr<lsp::incoming_request> r,
                                       common::position pos)
 {
-    auto get_hover = [r, pos](std::shared_ptr<vhdl::ast> ast) {
-        if (!ast || !ast->get_main_file())
+    auto get_hover = [r, pos](const vhdl::ast::snapshot* s) {
+        if (!s || !s->main_file)
         {
             r->reply(json::null_value);
             return;
         }
 
-        rapidjson::StringBuffer s;
-        rapidjson::Writer<rapidjson::StringBuffer> w(s);
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> w(sb);
 
         bool found = false;
         vhdl_hover_provider d(&w, found, pos);
-        ast->get_main_file()->traverse(d);
+        traverse_at(*s, pos, d);
     
         if (!found) {
             r->reply(json::null_value);
             return;
         }
 
-        json::string json = s.GetString();
+        json::string json = sb.GetString();
         r->reply(json);
     };
 
@@ -376,53 +867,96 @@ void things::vhdl_working_file::hover(std::shared_ptr<lsp::incoming_request> r,
 void things::vhdl_working_file::definition(
     std::shared_ptr<lsp::incoming_request> r, common::position pos)
 {
-    auto get_definition = [r, pos](std::shared_ptr<vhdl::ast> ast) {
-        if (!ast || !ast->get_main_file())
+    auto get_definition = [r, pos](const vhdl::ast::snapshot* s) {
+        if (!s || !s->main_file)
         {
             r->reply(json::null_value);
             return;
         }
 
-        rapidjson::StringBuffer s;
-        rapidjson::Writer<rapidjson::StringBuffer> w(s);
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> w(sb);
 
         bool found = false;
         vhdl_definition_provider d(&w, found, pos);
-        ast->get_main_file()->traverse(d);
+        traverse_at(*s, pos, d);
     
         if (!found) {
             r->reply(json::null_value);
             return;
         }
 
-        json::string json = s.GetString();
+        json::string json = sb.GetString();
         r->reply(json);
     };
 
     run_with_vhdl_ast(get_definition);
 }
 
-void things::vhdl_working_file::run_with_vhdl_ast(
-    std::function<void(std::shared_ptr<vhdl::ast>)> callback)
+template <typename F>
+bool things::vhdl_working_file::run_with_vhdl_snapshot(F& callback)
 {
-    auto run_that = [this, that = std::move(callback)](bool is_superseded) {
+    std::shared_ptr<vhdl::ast> owner;
+    std::shared_ptr<const vhdl::ast::snapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mutex_to_snapshot_);
+        if (!snapshot_is_current())
+            return false;
+        owner = snapshot_ast_;
+        snapshot = snapshot_;
+    }
+
+    post_snapshot_read([owner = std::move(owner),
+                        snapshot = std::move(snapshot),
+                        that = std::move(callback)]() {
+        that(snapshot.get());
+    });
+    return true;
+}
+
+template <typename F>
+void things::vhdl_working_file::run_with_vhdl_ast(F callback, bool outline_only)
+{
+    // reading the last analysed ast does not wait for the tasks of this file,
+    // eg the analysis which follows a save
+    if (run_with_vhdl_snapshot(callback))
+        return;
+
+    auto run_that = [this, outline_only,
+                     that = std::move(callback)](bool is_superseded) {
         if (is_superseded)
         {
             that(nullptr);
             return;
         }
 
+        if (outline_only && !ast && evicted_.load() && !stale_.load() &&
+            document_version() == evicted_text_version_)
+        {
+            that(nullptr);
+            return;
+        }
+
         make_sure_this_is_latest_project_version();
 
+        if (auto document = document_if_newer(ast->get_main_file_text_version()))
+            ast->set_main_file_text(std::move(std::get<0>(*document)),
+                                    std::get<1>(*document));
+
         auto was_already_uptodate = ast->update();
+        memory_estimate_ = ast->get_memory_estimate();
+        publish_snapshot();
 
         if (!was_already_uptodate)
             send_diagnostics_back_to_client_if_needed();
+        suggest_neighbours();
 
-        that(ast);
+        auto snapshot = ast->get_snapshot();
+        that(snapshot.get());
     };
 
-    return add_task("run_with_ast", std::move(run_that));
+    return add_task("run_with_ast", things::priority::interactive,
+                    std::move(run_that));
 }
 
 void things::vhdl_working_file::make_sure_this_is_latest_project_version()
@@ -442,6 +976,8 @@ void things::vhdl_working_file::make_sure_this_is_latest_project_version()
         if (work_libraries_.size() != 0)
             work = work_libraries_[0];
         ast = std::make_shared<vhdl::ast>(file_, libmgr, work.value_or("work"));
+        evicted_ = false;
+        stale_ = false;
     }
 }
 
@@ -482,6 +1018,12 @@ void things::vhdl_working_file::send_diagnostics_back_to_client_if_needed()
 
         diags.insert(diags.end(), parse_errors.begin(), parse_errors.end());
         // diags.insert(diags.end(), semantic_errors.begin(), semantic_errors.end());
+
+        // saves which change nothing, and the update of every file once the
+        // indexer is done, mostly come up with what the client already shows.
+        // The diagnostics are only formatted when sent
+        if (!diagnostics_changed(common::fingerprint(diags)))
+            return;
         client_->send_diagnostics(file_, diags);
     }
 }
@@ -593,7 +1135,8 @@ things::sv_working_file::sv_working_file(std::string file,
 {
 }
 
-void things::sv_working_file::update()
+void things::sv_working_file::update(things::priority p,
+                                     std::chrono::milliseconds delay)
 {
     auto analyse_and_diagnose = [this](bool is_superseded) {
         if (is_superseded)
@@ -613,12 +1156,32 @@ void things::sv_working_file::update()
             list_of_potentially_referenced_files_now_invalid.clear();
         }
 
+        if (auto document = document_if_newer(std::nullopt))
+            ast->set_main_file_text(std::move(std::get<0>(*document)),
+                                    std::get<1>(*document));
+
         ast->update();
+        memory_estimate_ = ast->get_memory_estimate();
+        publish_snapshot();
 
         send_diagnostics_back_to_client_if_needed();
     };
 
-    return add_task("update", std::move(analyse_and_diagnose));
+    return add_task("update", p, std::move(analyse_and_diagnose), delay);
+}
+
+void things::sv_working_file::drop_ast()
+{
+    ast.reset();
+    publish_snapshot();
+}
+
+void things::sv_working_file::publish_snapshot()
+{
+    std::lock_guard<std::mutex> lock(mutex_to_snapshot_);
+    snapshot_ = ast;
+    snapshot_published(ast != nullptr,
+                       ast ? ast->get_main_file_text_version() : std::nullopt);
 }
 
 void things::sv_working_file::folding_ranges(
@@ -641,7 +1204,7 @@ void things::sv_working_file::folding_ranges(
         json::string json = s.GetString();
         r->reply(json);
     };
-    run_with_sv_ast(calculate_folding_ranges);
+    run_with_sv_ast(calculate_folding_ranges, true);
 }
 
 void things::sv_working_file::symbols(
@@ -665,7 +1228,7 @@ void things::sv_working_file::symbols(
         r->reply(json);
     };
 
-    run_with_sv_ast(get_document_symbols);
+    run_with_sv_ast(get_document_symbols, true);
 }
 
 void things::sv_working_file::hover(std::shared_ptr<lsp::incoming_request> r,
@@ -706,9 +1269,27 @@ void things::sv_working_file::definition(
     run_with_sv_ast(get_definition);
 }
 
-void things::sv_working_file::run_with_sv_ast(
-    std::function<void(std::shared_ptr<sv::ast>)> callback)
+template <typename F>
+void things::sv_working_file::run_with_sv_ast(F callback, bool outline_only)
 {
+    // the syntax tree of the last analysis does not change, whatever the
+    // tasks of this file do
+    if (outline_only)
+    {
+        std::unique_lock<std::mutex> lock(mutex_to_snapshot_);
+        if (snapshot_is_current())
+        {
+            auto snapshot = snapshot_;
+            lock.unlock();
+
+            post_snapshot_read([snapshot = std::move(snapshot),
+                                that = std::move(callback)]() {
+                that(snapshot);
+            });
+            return;
+        }
+    }
+
     auto run_that = [this, that = std::move(callback)](bool is_superseded) {
         if (is_superseded)
         {
@@ -716,9 +1297,18 @@ void things::sv_working_file::run_with_sv_ast(
             return;
         }
 
-        make_sure_this_is_latest_project_version(false);
+        // slang cannot parse a new text with the same source manager, an
+        // edited document needs a new ast
+        auto document = document_if_newer(
+            ast ? ast->get_main_file_text_version() : std::nullopt);
+        make_sure_this_is_latest_project_version(document.has_value());
+        if (document)
+            ast->set_main_file_text(std::move(std::get<0>(*document)),
+                                    std::get<1>(*document));
 
         auto was_already_uptodate = ast->update();
+        memory_estimate_ = ast->get_memory_estimate();
+        publish_snapshot();
 
         if (!was_already_uptodate)
             send_diagnostics_back_to_client_if_needed();
@@ -726,7 +1316,8 @@ void things::sv_working_file::run_with_sv_ast(
         that(ast);
     };
 
-    return add_task("run_with_ast", std::move(run_that));
+    return add_task("run_with_ast", things::priority::interactive,
+                    std::move(run_that));
 }
 
 void things::sv_working_file::make_sure_this_is_latest_project_version(bool force)
@@ -748,6 +1339,8 @@ void things::sv_working_file::make_sure_this_is_latest_project_version(bool forc
         if (work_libraries_.size() != 0)
             work = work_libraries_[0];
         ast = std::make_shared<sv::ast>(file_, libmgr, work.value_or("work"), incdirs_);
+        evicted_ = false;
+        stale_ = false;
     }
 }
 
@@ -771,7 +1364,10 @@ void things::sv_working_file::send_diagnostics_back_to_client_if_needed()
             de.issue(diagnostic);
         }
 
-        client_->send_diagnostics(file_, dc->get_diagnostics()[file_]);
+        auto& diags = dc->get_diagnostics()[file_];
+        if (!diagnostics_changed(fingerprint(diags)))
+            return;
+        client_->send_diagnostics(file_, diags);
     }
 }
 
@@ -4,34 +4,58 @@
 
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
 
+#include "common/json.h"
 #include "vhdl/ast.h"
 #include "sv/ast.h"
 
+#include "common/inplace_function.h"
+#include "common/text_document.h"
+#include "lsp/structures.h"
+
+#include "prefetcher.h"
 #include "project.h"
+#include "scheduler.h"
+#include "thread_pool.h"
 
 namespace things
 {
 
 class client;
 
-class working_file: public std::enable_shared_from_this<working_file>
+// A working file is a strand: its tasks run one after the other on the
+// working files' thread pool, and tasks of different files run in parallel.
+class working_file: public std::enable_shared_from_this<working_file>,
+                    public things::strand
 {
+    // tasks capture little more than a request and a pointer. They are
+    // stored inline rather than on the heap
+    using task_function = common::inplace_function<void(bool)>;
+
     struct task
     {
         std::string name;
+        things::priority priority = things::priority::background;
         std::chrono::steady_clock::time_point request_time;
-        std::function<void(bool)> action;
+        task_function action;
 
         bool is_superseded = false;
+
+        // when the task was first held back for interactive tasks
+        std::optional<std::chrono::steady_clock::time_point> deferred_since;
+
+        // a debounced task does not run before then, unless superseded
+        std::optional<std::chrono::steady_clock::time_point> not_before;
     };
 
     public:
@@ -40,17 +64,49 @@ class working_file: public std::enable_shared_from_this<working_file>
     working_file(working_file&&) = delete;
     working_file& operator=(const working_file&) = delete;
     working_file& operator=(working_file&&) = delete;
-    ~working_file();
+    ~working_file() = default;
 
     void invalidate_potentially_referenced_file(std::string);
-    void forever_loop();
     void stop();
 
+    // The editor sends the content of the document when it opens it, and
+    // changes as they are typed. From then on, the document is analysed
+    // rather than the file on disk
+    void open(std::string_view, int);
+    void change(int, const std::vector<lsp::text_document_content_change_event>&);
+
+    // How long to wait after a change for the next one, before analysing the
+    // document
+    static constexpr std::chrono::milliseconds change_debounce{50};
+
+    // things::strand
+    result run_one() override;
+
+    // Memory held by the ast of this file, as estimated when it was last
+    // built. 0 when there is no ast. Can be called from any thread
+    std::size_t get_memory_estimate() const;
+
+    // Drop the ast, unless a task is queued or running. Diagnostics stay with
+    // the client, and whatever answers requests without the ast is kept. The
+    // next request needing the ast rebuilds it. Returns true if evicted
+    bool evict();
+    bool is_evicted() const;
+
+    // Note that an evicted file missed an update, eg the one which follows
+    // the indexer or a change on disk. Its next request rebuilds the ast, and
+    // sends its diagnostics again, even if it only needs the outline
+    void mark_stale();
+
+    // when the file was last asked something, for eviction. Only the main
+    // thread uses it
+    std::uint64_t last_used = 0;
+
     // virtual functions that every derived working files must implement. This
     // is because the way to gather folding ranges, document symbols etc will
     // depend on the file parser / ast and will need its own bespoke
     // implementation. 
-    virtual void update() = 0;
+    virtual void drop_ast() = 0;
+    virtual void update(things::priority, std::chrono::milliseconds) = 0;
     virtual void folding_ranges(std::shared_ptr<lsp::incoming_request>) = 0;
     virtual void symbols       (std::shared_ptr<lsp::incoming_request>) = 0;
     virtual void hover         (std::shared_ptr<lsp::incoming_request>, common::position) = 0;
@@ -58,12 +114,11 @@ class working_file: public std::enable_shared_from_this<working_file>
 
     // we support two run policies.
     // - Run on main thread: This will run tasks on the main thread.
-    // - Run on different thread: This will run all tasks on a different thread
-    //   In this case, there will be a `thread` running `this->foreveer_loop()`
-    //   and tasks will be queued and processed first come first served.
+    // - Run on different thread: Tasks are queued and the working file is
+    //   submitted to `pool`, which processes them first come first served.
     enum run_policy { run_on_main_thread, run_on_different_thread };
     run_policy policy;
-    std::thread thread;
+    things::thread_pool* pool = nullptr;
 
     protected:
     std::string file_;
@@ -71,10 +126,26 @@ class working_file: public std::enable_shared_from_this<working_file>
     things::project* project_;
 
     std::mutex mutex_;
-    std::condition_variable cv_;
     std::deque<task> queue_;
 
-    void add_task(std::string, std::function<void(bool)>);
+    // true from the moment the working file is submitted to the pool until it
+    // runs out of tasks
+    bool scheduled_ = false;
+
+    void add_task(std::string, things::priority, task_function,
+                  std::chrono::milliseconds = std::chrono::milliseconds(0));
+    void run(task&);
+    void cancel_queued_tasks();
+
+    // the document as the editor sees it. Changes arrive on the main thread
+    // while the document is analysed on the pool
+    std::mutex mutex_to_document_;
+    std::optional<common::text_document> document_;
+
+    // Return the text and version of the document, if the editor sent it and
+    // its version is not the given one
+    std::optional<std::tuple<std::string, int>>
+    document_if_newer(std::optional<int>);
 
 
     // We should keep track of the current loaded project version number as it
@@ -91,19 +162,51 @@ class working_file: public std::enable_shared_from_this<working_file>
     std::vector<std::string> list_of_potentially_referenced_files_now_invalid;
 
     std::atomic_bool stopped_ = false;
+
+    std::atomic<std::size_t> memory_estimate_ = 0;
+    std::atomic_bool evicted_ = false;
+    std::atomic_bool stale_ = false;
+
+    // Return the version of the document, if the editor sent it
+    std::optional<int> document_version();
+
+    // Derived working files publish a snapshot of their last analysis, which
+    // requests can read on the pool while the tasks of the file run. What the
+    // snapshot was built from is kept here, guarded by mutex_to_snapshot_
+    std::mutex mutex_to_snapshot_;
+    bool has_snapshot_ = false;
+    std::optional<int> snapshot_text_version_;
+    int snapshot_project_version_ = 0;
+    bool snapshot_library_fully_loaded_ = false;
+
+    // mutex_to_snapshot_ must be held. Note that the snapshot was built from
+    // the given text version, or that there is none
+    void snapshot_published(bool, std::optional<int>);
+
+    // mutex_to_snapshot_ must be held. Return true if the snapshot was built
+    // from the current document and project, so that it answers requests as
+    // well as a new analysis would
+    bool snapshot_is_current();
+
+    // Run a read of the snapshot on the pool, as an interactive request
+    void post_snapshot_read(common::inplace_function<void()>);
+
+    // The fingerprint of the diagnostics last sent to the client. Only tasks
+    // use it. Return true, and remember the fingerprint, if the diagnostics
+    // are not the ones the client has already
+    std::optional<std::uint64_t> diagnostics_fingerprint_;
+    bool diagnostics_changed(std::uint64_t);
 };
 
 // forward declaration because of cyclic dependence issues
 class language;
 
-// this is only used by the main thread. So there should be no need for mutexes
-// and other thread synchronisation primitives. Instances of working_files are
-// not meant to be moved around and definitely not meant to be copied.
+// this is only used by the main thread, but for the few functions which say
+// otherwise. Instances of working_files are not meant to be moved around and
+// definitely not meant to be copied.
 //
-// The synchronisation primitives here are because working_files create threads
-// on the go. It needs to keep track of how many threads are running and also
-// needs to ensure that no threads are running when it is destroyed. These
-// primitives are here to ensure this is done properly.
+// The working files share a fixed size thread pool rather than having a
+// thread each, most of them being idle most of the time.
 class working_files
 {
     public:
@@ -114,26 +217,66 @@ class working_files
     working_files& operator=(working_files&&) = delete;
     ~working_files();
 
-    bool update(std::string);
+    bool open(std::string, std::string_view, int);
+    void change(std::string, int,
+                const std::vector<lsp::text_document_content_change_event>&);
+    bool update(std::string, things::priority);
     void remove(std::string);
+
+    // these can be called from any thread
     void update_all_files();
 
+    // A file changed on disk rather than in the editor. Every working file
+    // reloads what it loaded from it, and those depending on it are analysed
+    // again
+    void changed_on_disk(const std::string&, const std::vector<std::string>&);
+
     void folding_ranges(std::string, std::shared_ptr<lsp::incoming_request>);
     void symbols       (std::string, std::shared_ptr<lsp::incoming_request>);
     void hover         (std::string, std::shared_ptr<lsp::incoming_request>, common::position);
     void definition    (std::string, std::shared_ptr<lsp::incoming_request>, common::position);
 
+    // these can be called from any thread
+    std::size_t get_number_of_files() const;
+    unsigned get_number_of_threads() const;
+
+    // The asts of the working files are evicted, least recently used first,
+    // once their estimated memory goes over the budget. 0 means no budget
+    void set_memory_budget(std::size_t);
+    static constexpr std::size_t default_memory_budget = std::size_t(1) << 30;
+
+    // The memory the asts of files likely to be opened next may take. 0 stops
+    // analysing them ahead of time
+    void set_prefetch_memory_budget(std::size_t);
+
     private:
+    bool add(const std::string&);
+
+    // note that the file is being used, and evict other files if needed
+    void touch(const std::string&);
+    void enforce_memory_budget(working_file*);
+
     std::unordered_map<std::string, std::shared_ptr<working_file>>
         working_files_;
 
-    mutable std::mutex mutex_;
-    mutable std::condition_variable no_running_threads_;
-    int number_of_running_threads_;
+    // held by the main thread while it adds or removes working files, and by
+    // other threads while they go through them
+    std::mutex mutex_to_working_files_;
+    std::atomic<std::size_t> number_of_files_ = 0;
+
+    std::size_t memory_budget_ = default_memory_budget;
+    std::uint64_t last_used_ = 0;
 
     things::language* server_;
     things::client* client_;
     bool everything_on_main_thread;
+
+    // nullptr when everything runs on the main thread
+    std::shared_ptr<things::prefetcher> prefetcher_;
+
+    // declared last so that it is destroyed first, while the working files
+    // its threads may still be running are alive
+    things::thread_pool pool_;
 };
 
 
@@ -142,17 +285,61 @@ class vhdl_working_file : public working_file
     public:
     vhdl_working_file(std::string, things::client*, things::project*);
 
-    void update();
+    void drop_ast();
+    void update(things::priority, std::chrono::milliseconds);
     void folding_ranges(std::shared_ptr<lsp::incoming_request>);
     void symbols       (std::shared_ptr<lsp::incoming_request>);
     void hover         (std::shared_ptr<lsp::incoming_request>, common::position);
     void definition    (std::shared_ptr<lsp::incoming_request>, common::position);
 
+    // Start from an ast the prefetcher built. Only before any task is queued
+    void adopt(things::prefetcher::prefetched);
+
+    // told about the files likely opened after this one, if set
+    std::shared_ptr<things::prefetcher> prefetcher;
+
     private:
     std::shared_ptr<vhdl::ast> ast;
     std::vector<std::string> work_libraries_;
 
-    void run_with_vhdl_ast(std::function<void(std::shared_ptr<vhdl::ast>)>);
+    // the neighbours are suggested once, when the libraries are populated
+    bool neighbours_suggested_ = false;
+    void suggest_neighbours();
+
+    // Folding ranges and document symbols only depend on the syntax tree of
+    // the main file, and clients ask for them on every focus change and save.
+    // Keep the serialized reply along with the version of the main file it was
+    // computed from. Superseded requests are answered from here as well
+    struct cached_reply
+    {
+        std::uint64_t version = 0;
+        std::optional<json::string> json;
+    };
+    cached_reply folding_ranges_;
+    cached_reply symbols_;
+    std::mutex mutex_to_replies_;
+    json::string folding_ranges_json(const vhdl::ast::snapshot&);
+    json::string symbols_json(const vhdl::ast::snapshot&);
+    json::string last_reply(const cached_reply&);
+
+    // the snapshot of the last analysis, along with the ast whose strings it
+    // refers to. Guarded by mutex_to_snapshot_
+    std::shared_ptr<vhdl::ast> snapshot_ast_;
+    std::shared_ptr<const vhdl::ast::snapshot> snapshot_;
+    void publish_snapshot();
+
+    // the version of the text the ast was built from when it was evicted. The
+    // cached replies hold as long as the document is at that version
+    std::optional<int> evicted_text_version_;
+
+    // Requests which only need the outline do not rebuild an evicted ast
+    template <typename F>
+    void run_with_vhdl_ast(F, bool outline_only = false);
+
+    // Run the callback against the snapshot, and move from it, if the
+    // snapshot is current. Returns false otherwise
+    template <typename F>
+    bool run_with_vhdl_snapshot(F&);
     void make_sure_this_is_latest_project_version();
     void send_diagnostics_back_to_client_if_needed();
 };
@@ -162,7 +349,8 @@ class sv_working_file : public working_file
     public:
     sv_working_file(std::string, things::client*, things::project*);
 
-    void update();
+    void drop_ast();
+    void update(things::priority, std::chrono::milliseconds);
     void folding_ranges(std::shared_ptr<lsp::incoming_request>);
     void symbols       (std::shared_ptr<lsp::incoming_request>);
     void hover         (std::shared_ptr<lsp::incoming_request>, common::position);
@@ -173,7 +361,15 @@ class sv_working_file : public working_file
     std::vector<std::string> work_libraries_;
     std::vector<std::string> incdirs_;
 
-    void run_with_sv_ast(std::function<void(std::shared_ptr<sv::ast>)>);
+    // The syntax tree of the last analysis. Outline requests read it while
+    // tasks of this file run. Hover needs the compilation, which slang
+    // elaborates lazily, so it waits for the tasks. Guarded by
+    // mutex_to_snapshot_
+    std::shared_ptr<sv::ast> snapshot_;
+    void publish_snapshot();
+
+    template <typename F>
+    void run_with_sv_ast(F, bool outline_only = false);
     void make_sure_this_is_latest_project_version(bool=true);
     void send_diagnostics_back_to_client_if_needed();
 };
@@ -3,15 +3,26 @@
 
 #include "vhdl/parser.h"
 #include "vhdl/binder.h"
+#include "vhdl/standard_libraries.h"
 #include "vhdl_syntax.h"
+#include "common/trace.h"
 
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <unordered_set>
 
 namespace Err
 {
     constexpr std::string_view File_Not_Found = "{} not found";
 }
 
+// versions of the main files, shared by all asts
+static std::atomic<std::uint64_t> last_main_file_version = 0;
+
+// roughly what a parsed and analysed design file takes, per byte of source
+static constexpr std::size_t bytes_per_source_byte = 12;
+
 std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
            std::optional<std::string>, std::string, time_t>
 convert_to_tuple(vhdl::node::library_unit* ptr)
@@ -47,9 +58,35 @@ convert_to_tuple(vhdl::node::library_unit* ptr)
                            ptr->syntax->file->filename, 0);
 }
 
+// Return true if the design unit is the primary unit named identifier. An
+// entity or a package is looked up by a single identifier, a configuration is
+// looked up with the identifier of the entity as well
+bool is_primary_unit(vhdl::syntax::design_unit* unit,
+                     std::string_view identifier,
+                     std::optional<std::string_view> identifier2)
+{
+    switch (unit->v_kind) {
+    case vhdl::syntax::design_unit::v_::entity:
+        return !identifier2.has_value() &&
+               unit->v.entity.identifier.value == identifier;
+
+    case vhdl::syntax::design_unit::v_::package:
+        return !identifier2.has_value() &&
+               unit->v.package.identifier.value == identifier;
+
+    case vhdl::syntax::design_unit::v_::configuration:
+        return identifier2.has_value() &&
+               unit->v.configuration.identifier.value == identifier;
+
+    default:
+        return false;
+    }
+}
+
 vhdl::ast::ast(std::string f, std::shared_ptr<vhdl::library_manager> m,
                std::string w)
-    : filename(f), library_manager(m), worklibrary(w), invalidated_(true)
+    : filename(f), library_manager(m), worklibrary(w),
+      main_file_snapshot(std::make_shared<snapshot>()), invalidated_(true)
 {
 
 }
@@ -59,6 +96,18 @@ void vhdl::ast::invalidate_main_file()
     invalidated_ = true;
 }
 
+void vhdl::ast::set_main_file_text(std::string text, int version)
+{
+    main_file_text = std::move(text);
+    main_file_text_version = version;
+    invalidated_ = true;
+}
+
+std::optional<int> vhdl::ast::get_main_file_text_version()
+{
+    return main_file_text_version;
+}
+
 void vhdl::ast::invalidate_reference_file(std::string& file)
 {
     for (auto& [lib, unit] : cached_library_units) {
@@ -78,42 +127,58 @@ bool vhdl::ast::update()
     if (!invalidated_)
         return true;
 
-    std::ifstream content(filename);
-    if(!content.good())
+    auto file = std::make_shared<vhdl::syntax::design_file>();
+    file->filename = filename;
+
+    if (main_file_text)
+        file->src.assign(main_file_text->begin(), main_file_text->end());
+    else
     {
-        parse_errors.clear();
-        semantic_errors.clear();
-        main_file.reset();
-        return false;
-    }
+        std::ifstream content(filename);
+        if(!content.good())
+        {
+            parse_errors.clear();
+            semantic_errors.clear();
+            forget_main_file_units();
+            main_file.reset();
+            main_file_snapshot = std::make_shared<snapshot>();
+            return false;
+        }
 
-    content.seekg(0, std::ios::end);
-    auto size = content.tellg();
-    content.seekg(0);
+        content.seekg(0, std::ios::end);
+        auto size = content.tellg();
+        content.seekg(0);
 
-    auto file = std::make_shared<vhdl::syntax::design_file>();
-    file->filename = filename;
-    file->src.resize(size);
-    content.read(file->src.data(), size);
+        file->src.resize(size);
+        content.read(file->src.data(), size);
+    }
 
     // parse
+    auto start = std::chrono::steady_clock::now();
+    vhdl::outline outline;
     vhdl::parser parse_file(&strings, file.get());
+    parse_file.collect_outline(&outline);
     auto [ok, diags] = parse_file();
+    get_statistics().parse.record(std::chrono::steady_clock::now() - start);
 
     parse_errors.swap(diags);
+    forget_main_file_units();
     main_file = file;
 
+    // published once the main file is analysed
+    auto next = std::make_shared<snapshot>();
+    next->main_file = file;
+    next->positions = vhdl::position_index(file.get());
+    next->outline = std::move(outline);
+    next->main_file_version = ++last_main_file_version;
+    next->text_version = main_file_text_version;
+
     // some cache house keeping
     auto& cache = cached_library_units[worklibrary];
     std::vector<std::shared_ptr<vhdl::node::library_unit>>
         libunits_we_just_parsed;
     for (auto unit : main_file->units)
     {
-        auto it = std::remove_if(
-            cache.begin(), cache.end(),
-            [lhs = unit](auto const& rhs) { return lhs == rhs->syntax; });
-        cache.erase(it, cache.end());
-
         auto libunit = std::make_shared<vhdl::node::library_unit>();
         libunit->state = vhdl::node::library_unit_state::parsed;
         libunit->syntax = unit;
@@ -123,6 +188,7 @@ bool vhdl::ast::update()
     }
 
     main_file->owns_units = false;
+    next->units = libunits_we_just_parsed;
 
     auto lib = library_manager->get(worklibrary);
 
@@ -130,14 +196,8 @@ bool vhdl::ast::update()
     std::vector<common::diagnostic> big_diags;
     for (auto& libunit: libunits_we_just_parsed)
     {
-        libunit->state = vhdl::node::library_unit_state::analysing;
-
-        vhdl::semantic::binder bind(this, libunit);
-        auto [ok, rdclrgn, diags] = bind();
-
+        auto diags = analyse(libunit);
         big_diags.insert(big_diags.end(), diags.begin(), diags.end());
-        libunit->root_declarative_region = rdclrgn;
-        libunit->state = vhdl::node::library_unit_state::analysed;
     }
 
     semantic_errors.swap(big_diags);
@@ -146,15 +206,47 @@ bool vhdl::ast::update()
         for (auto& libunit: libunits_we_just_parsed)
             lib->put(convert_to_tuple(libunit.get()));
 
+    main_file_snapshot = std::move(next);
     invalidated_ = false;
     return false;
 }
 
+void vhdl::ast::forget_main_file_units()
+{
+    // the snapshots keep what they need of the units dropped
+    auto& cache = cached_library_units[worklibrary];
+    auto it = std::remove_if(cache.begin(), cache.end(), [this](auto const& u) {
+        return (main_file && u->file == main_file) ||
+               u->syntax->file->filename == filename;
+    });
+    cache.erase(it, cache.end());
+}
+
 vhdl::syntax::design_file* vhdl::ast::get_main_file()
 {
     return main_file.get();
 }
 
+const vhdl::position_index& vhdl::ast::get_position_index()
+{
+    return main_file_snapshot->positions;
+}
+
+const vhdl::outline& vhdl::ast::get_outline()
+{
+    return main_file_snapshot->outline;
+}
+
+std::uint64_t vhdl::ast::get_main_file_version()
+{
+    return main_file_snapshot->main_file_version;
+}
+
+std::shared_ptr<const vhdl::ast::snapshot> vhdl::ast::get_snapshot()
+{
+    return main_file_snapshot;
+}
+
 std::tuple<std::vector<common::diagnostic>, std::vector<common::diagnostic>>
 vhdl::ast::get_diagnostics()
 {
@@ -166,94 +258,44 @@ vhdl::ast::load_primary_unit(std::optional<std::string> library,
                              std::string_view identifier,
                              std::optional<std::string_view> identifier2)
 {
+    TRACE_SPAN("load_primary_unit", identifier);
+
     std::vector<std::shared_ptr<vhdl::node::library_unit>> candidates;
 
     auto& cache = cached_library_units[library.value_or(worklibrary)];
     for (auto& libunit: cache) {
-        switch (libunit->state) {
-        case vhdl::node::library_unit_state::outdated:
-        case vhdl::node::library_unit_state::parsed:
-            // do nothing. These will be evicted from the cache below
+        // outdated units will be evicted from the cache below. Units that are
+        // only parsed are fine: they are bound on demand
+        if (libunit->state == vhdl::node::library_unit_state::outdated)
             continue;
 
-        default:
-            break;
-        }
-
-        switch (libunit->syntax->v_kind) {
-        case vhdl::syntax::design_unit::v_::entity:
-            if (identifier2.has_value())
-                break;
-            if (libunit->syntax->v.entity.identifier.value != identifier)
-                break;
+        if (is_primary_unit(libunit->syntax, identifier, identifier2))
             candidates.push_back(libunit);
-            break;
-
-        case vhdl::syntax::design_unit::v_::package:
-            if (identifier2.has_value())
-                break;
-            if (libunit->syntax->v.package.identifier.value != identifier)
-                break;
-            candidates.push_back(libunit);
-            break;
-
-        case vhdl::syntax::design_unit::v_::configuration:
-            if (!identifier2.has_value())
-                break;
-            if (libunit->syntax->v.configuration.identifier.value != identifier)
-                break;
-            candidates.push_back(libunit);
-            break;
-
-        default:
-            break;
-        }
     }
 
-    if (candidates.size())
-        return candidates;
+    for (auto& libunit: candidates)
+        if (libunit->state == vhdl::node::library_unit_state::parsed)
+            analyse(libunit);
 
-    auto be = library_manager->get(library.value_or(worklibrary));
-    if (!be->is_known())
+    if (candidates.size())
     {
+        get_statistics().cache_hits++;
         return candidates;
     }
 
-    std::optional<std::string> oid2 = identifier2.has_value() ?
-                            std::make_optional<std::string>(*identifier2)
-                          : std::nullopt;
-    auto [kind, line, column, id1, id2, filename, time] =
-        be->get(std::string(identifier), oid2);
-    switch (kind) {
-    case vhdl::library_unit_kind::entity:
-    case vhdl::library_unit_kind::package:
-    case vhdl::library_unit_kind::configuration:
-        break;
-
-    case vhdl::library_unit_kind::architecture:
-    case vhdl::library_unit_kind::package_body:
-    default:
-        return candidates; // Could not find what we are looking for. Return
-                           // empty candidate list
-    }
+    get_statistics().cache_misses++;
 
-    // if we are here, actually load from library and start parse and analysis
-    std::ifstream content(filename);
-    if (!content.good())
+    auto be = library_manager->get(library.value_or(worklibrary));
+    auto file = read_primary_unit(be.get(), library.value_or(worklibrary),
+                                  identifier, identifier2);
+    if (!file)
         return candidates;
 
-    content.seekg(0, std::ios::end);
-    auto size = content.tellg();
-    content.seekg(0);
-
-    auto file = std::make_shared<vhdl::syntax::design_file>();
-    file->filename = filename;
-    file->src.resize(size);
-    content.read(file->src.data(), size);
-
     // parse
+    auto start = std::chrono::steady_clock::now();
     vhdl::parser parse_file(&strings, file.get());
     auto [ok, diags] = parse_file();
+    get_statistics().parse.record(std::chrono::steady_clock::now() - start);
 
     // more cache house keeping
     std::vector<std::shared_ptr<vhdl::node::library_unit>>
@@ -272,39 +314,91 @@ vhdl::ast::load_primary_unit(std::optional<std::string> library,
         cache.push_back(libunit);
         libunits_we_just_parsed.push_back(libunit);
 
-        switch (unit->v_kind)
-        {
-        case vhdl::syntax::design_unit::v_::entity:
-            if (unit->v.entity.identifier.value == identifier &&
-                kind == vhdl::library_unit_kind::entity)
-                candidates.push_back(libunit);
-            break;
-        case vhdl::syntax::design_unit::v_::package:
-            if (unit->v.package.identifier.value == identifier &&
-                kind == vhdl::library_unit_kind::package)
-                candidates.push_back(libunit);
-            break;
+        if (is_primary_unit(unit, identifier, identifier2))
+            candidates.push_back(libunit);
+    }
 
+    file->owns_units = false;
+
+    // semantic analysis. Only the requested primary unit is analysed now. Its
+    // siblings stay in the parsed state until something references them.
+    // Files stored in libraries can contain a lot of design units, and most
+    // of them are usually never needed.
+    for (auto& libunit : candidates)
+        analyse(libunit);
+
+    return candidates;
+}
+
+std::shared_ptr<vhdl::syntax::design_file>
+vhdl::ast::read_primary_unit(vhdl::library_backend* be,
+                             const std::string& library,
+                             std::string_view identifier,
+                             std::optional<std::string_view> identifier2)
+{
+    if (be->is_known())
+    {
+        std::optional<std::string> oid2 = identifier2.has_value() ?
+                                std::make_optional<std::string>(*identifier2)
+                              : std::nullopt;
+        auto [kind, line, column, id1, id2, filename, time] =
+            be->get(std::string(identifier), oid2);
+        switch (kind) {
+        case vhdl::library_unit_kind::entity:
+        case vhdl::library_unit_kind::package:
+        case vhdl::library_unit_kind::configuration: {
+            std::ifstream content(filename);
+            if (!content.good())
+                return nullptr;
+
+            content.seekg(0, std::ios::end);
+            auto size = content.tellg();
+            content.seekg(0);
+
+            auto file = std::make_shared<vhdl::syntax::design_file>();
+            file->filename = filename;
+            file->src.resize(size);
+            content.read(file->src.data(), size);
+            return file;
+        }
+
+        case vhdl::library_unit_kind::architecture:
+        case vhdl::library_unit_kind::package_body:
         default:
             break;
         }
     }
 
-    file->owns_units = false;
+    // std and ieee do not need to be part of the project. Fall back to the
+    // copy embedded in the executable. A library listed in the project still
+    // takes precedence, so that users can bring their own ieee
+    if (identifier2.has_value())
+        return nullptr;
 
-    // semantic analysis
-    for (auto& libunit : libunits_we_just_parsed)
-    {
-        libunit->state = vhdl::node::library_unit_state::analysing;
+    auto embedded = vhdl::stdlib::find(library, identifier);
+    if (!embedded)
+        return nullptr;
 
-        vhdl::semantic::binder bind(this, libunit);
-        auto [ok, rdclrgn, diags] = bind();
+    auto file = std::make_shared<vhdl::syntax::design_file>();
+    file->filename = embedded->filename;
+    file->src.assign(embedded->text.begin(), embedded->text.end());
+    return file;
+}
 
-        libunit->root_declarative_region = rdclrgn;
-        libunit->state = vhdl::node::library_unit_state::analysed;
-    }
+std::vector<common::diagnostic>
+vhdl::ast::analyse(std::shared_ptr<vhdl::node::library_unit>& libunit)
+{
+    libunit->state = vhdl::node::library_unit_state::analysing;
 
-    return candidates;
+    TRACE_SPAN("bind", libunit->file->filename);
+    auto start = std::chrono::steady_clock::now();
+    vhdl::semantic::binder bind(this, libunit);
+    auto [ok, rdclrgn, diags] = bind();
+    get_statistics().analyse.record(std::chrono::steady_clock::now() - start);
+
+    libunit->root_declarative_region = rdclrgn;
+    libunit->state = vhdl::node::library_unit_state::analysed;
+    return diags;
 }
 
 std::string vhdl::ast::get_work_library_name()
@@ -312,11 +406,136 @@ std::string vhdl::ast::get_work_library_name()
     return worklibrary;
 }
 
+namespace
+{
+
+// Collect the units instantiated by component and entity instantiations, as
+// the library, if one is given, and the identifier of the unit. A component
+// is taken to be bound to the entity of the same name
+class instance_collector: public vhdl::syntax::visitor
+{
+    public:
+    using vhdl::syntax::visitor::visit;
+
+    bool visit(vhdl::syntax::concurrent_statement* c) override
+    {
+        if (c->v_kind != vhdl::syntax::concurrent_statement::v_::inst)
+            return true;
+
+        auto unit = c->v.inst.inst;
+        switch (unit->v_kind) {
+        case vhdl::syntax::instantiated_unit::v_::component:
+            add(unit->v.component.unit);
+            break;
+        case vhdl::syntax::instantiated_unit::v_::entity:
+            add(unit->v.entity.unit);
+            break;
+        default:
+            break;
+        }
+        return true;
+    }
+
+    std::vector<std::tuple<std::optional<std::string_view>, std::string_view>>
+        units;
+
+    private:
+    void add(vhdl::syntax::name* n)
+    {
+        if (!n)
+            return;
+
+        switch (n->v_kind) {
+        case vhdl::syntax::name::v_::simple:
+            units.emplace_back(std::nullopt, n->v.simple.identifier.value);
+            break;
+        case vhdl::syntax::name::v_::selected: {
+            auto prefix = n->v.selected.prefix;
+            if (prefix && prefix->v_kind == vhdl::syntax::name::v_::simple)
+                units.emplace_back(prefix->v.simple.identifier.value,
+                                   n->v.selected.identifier.value);
+        }   break;
+        default:
+            break;
+        }
+    }
+};
+
+}
+
+std::vector<std::string> vhdl::ast::get_neighbour_files(std::size_t max)
+{
+    std::vector<std::string> files;
+    std::unordered_set<std::string> seen = {filename};
+    auto add = [&](const std::string& file) {
+        if (files.size() < max && seen.insert(file).second)
+            files.push_back(file);
+    };
+
+    if (main_file)
+    {
+        instance_collector c;
+        main_file->traverse_static(c);
+        for (auto& [library, identifier] : c.units)
+        {
+            auto name = library && *library != "work" ? std::string(*library)
+                                                       : worklibrary;
+            auto be = library_manager->get(name);
+            if (!be->is_known())
+                continue;
+
+            // the entity, and the architectures which name it
+            for (auto& [kind, line, column, id1, id2, file, time] :
+                 be->all(0, std::string(identifier)))
+                if (kind == vhdl::library_unit_kind::entity ||
+                    kind == vhdl::library_unit_kind::architecture)
+                    add(file);
+        }
+    }
+
+    for (auto& [library, units] : cached_library_units)
+    {
+        if (!library_manager->get(library)->is_known())
+            continue;
+
+        for (auto& unit : units)
+            if (unit->file)
+                add(unit->file->filename);
+    }
+
+    return files;
+}
+
 bool vhdl::ast::is_uptodate()
 {
     return main_file != nullptr;
 }
 
+std::size_t vhdl::ast::get_memory_estimate()
+{
+    std::unordered_set<const vhdl::syntax::design_file*> files;
+    std::size_t source = 0;
+
+    auto count = [&](const vhdl::syntax::design_file* file) {
+        if (file && files.insert(file).second)
+            source += file->src.size();
+    };
+
+    count(main_file.get());
+    for (auto& [library, units] : cached_library_units)
+        for (auto& unit : units)
+            count(unit->file.get());
+
+    return strings.get_size_in_bytes() + source * bytes_per_source_byte +
+           (main_file_text ? main_file_text->size() : 0);
+}
+
+vhdl::ast::statistics& vhdl::ast::get_statistics()
+{
+    static statistics stats;
+    return stats;
+}
+
 bool vhdl::is_a_vhdl_file(std::string& ext)
 {
     return ext == ".vhd" || ext == ".vhdl";
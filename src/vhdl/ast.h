@@ -2,11 +2,18 @@
 #ifndef VHDL_AST_H
 #define VHDL_AST_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "vhdl/library_manager.h"
+#include "vhdl/outline.h"
+#include "vhdl/position_index.h"
 #include "common/diagnostics.h"
+#include "common/histogram.h"
 #include "common/stringtable.h"
 
 namespace vhdl
@@ -55,6 +62,15 @@ class ast: public std::enable_shared_from_this<vhdl::ast>
     // this function will return quickly
     void invalidate_reference_file(std::string&);
 
+    // this function will return quickly
+    // Parse the given text instead of reading the main file, eg the content of
+    // the file as it is being edited. The version identifies the text
+    void set_main_file_text(std::string, int);
+
+    // this function will return quickly
+    // Return the version of the text given to set_main_file_text(), if any
+    std::optional<int> get_main_file_text_version();
+
     // this function will return quickly
     // Note that the main file might be out of date if invalidate_x() functions
     // were called between the last update() and this one. However, the main
@@ -63,6 +79,44 @@ class ast: public std::enable_shared_from_this<vhdl::ast>
     // found
     vhdl::syntax::design_file* get_main_file();
 
+    // this function will return quickly
+    // Return the position index of the main file. It is rebuilt by update()
+    // every time the main file is parsed, so it always matches get_main_file()
+    const vhdl::position_index& get_position_index();
+
+    // this function will return quickly
+    // Return the outline of the main file, collected while parsing it
+    const vhdl::outline& get_outline();
+
+    // this function will return quickly
+    // Return a number identifying the current parse of the main file. It
+    // changes every time update() parses the main file, and is never reused,
+    // not even by another ast. Results derived from the syntax tree alone can
+    // be cached against it. Returns 0 if there is no main file
+    std::uint64_t get_main_file_version();
+
+    // What update() built from the main file. A snapshot is never modified
+    // once update() returns it, a new one is built instead. Readers on other
+    // threads can keep using it while the ast is updated. The snapshot owns
+    // the library units of the main file, which own its design units and,
+    // through their dependencies, the units they refer to. The identifiers
+    // are kept in the strings of the ast: readers keep the ast alive too
+    struct snapshot
+    {
+        std::shared_ptr<vhdl::syntax::design_file> main_file;
+        std::vector<std::shared_ptr<vhdl::node::library_unit>> units;
+        vhdl::position_index positions;
+        vhdl::outline outline;
+        std::uint64_t main_file_version = 0;
+
+        // the version of the text given to set_main_file_text(), if any
+        std::optional<int> text_version;
+    };
+
+    // this function will return quickly
+    // Return the snapshot of the last update(). Never nullptr
+    std::shared_ptr<const snapshot> get_snapshot();
+
     // this function will return quickly
     // return the current parse errors and semantic errors.
     //
@@ -73,6 +127,9 @@ class ast: public std::enable_shared_from_this<vhdl::ast>
     get_diagnostics();
 
     // Load primary unit from a library.
+    // Only the requested primary unit gets analysed. The other units living in
+    // the same file are parsed and cached, but they are analysed only when
+    // something asks for them.
     std::vector<std::shared_ptr<vhdl::node::library_unit>> load_primary_unit(
         std::optional<std::string>, std::string_view,
         std::optional<std::string_view>);
@@ -80,18 +137,60 @@ class ast: public std::enable_shared_from_this<vhdl::ast>
     // Get work library where the main design units in this ast shall be stored
     std::string get_work_library_name();
 
+    // Return the files a user is likely to open after the main file, at most
+    // the given number: the files declaring the entities the main file
+    // instantiates and their architectures, then the files of the library
+    // units loaded to analyse it. Only files of the libraries of the project
+    // are returned. This function queries the libraries
+    std::vector<std::string> get_neighbour_files(std::size_t);
+
     // Return true if no invalidate_x() functions were called between the last
     // update() and this one.
     bool is_uptodate();
 
+    // this function will return quickly
+    // Estimate the memory held by this ast: its strings, and the main file and
+    // the files of the library units it loaded. Syntax trees and declarative
+    // regions are not measured, they are taken to be a multiple of the source
+    std::size_t get_memory_estimate();
+
+    // Counters shared by all asts
+    struct statistics
+    {
+        common::histogram parse;   // main files and files read from libraries
+        common::histogram analyse; // one library unit, and what it loads
+        std::atomic<std::uint64_t> cache_hits = 0;   // load_primary_unit()
+        std::atomic<std::uint64_t> cache_misses = 0;
+    };
+
+    static statistics& get_statistics();
+
     private:
 
+    // Read the source text of the file which declares a primary unit. Look in
+    // the library backend first, then in the embedded standard libraries.
+    // Returns nullptr if the primary unit could not be found
+    std::shared_ptr<vhdl::syntax::design_file>
+    read_primary_unit(vhdl::library_backend*, const std::string&,
+                      std::string_view, std::optional<std::string_view>);
+
+    // Drop the library units of the main file from the cache, those of the
+    // last parse and any copy loaded from a library, before it is parsed again
+    void forget_main_file_units();
+
+    // Bind a parsed library unit and return the semantic errors found
+    std::vector<common::diagnostic>
+    analyse(std::shared_ptr<vhdl::node::library_unit>&);
+
     std::string filename;
     std::string worklibrary;
     common::stringtable strings;
 
     std::shared_ptr<vhdl::library_manager> library_manager;
+    std::optional<std::string> main_file_text;
+    std::optional<int> main_file_text_version;
     std::shared_ptr<vhdl::syntax::design_file> main_file;
+    std::shared_ptr<const snapshot> main_file_snapshot;
 
     std::vector<common::diagnostic> parse_errors;
     std::vector<common::diagnostic> semantic_errors;
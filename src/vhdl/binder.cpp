@@ -134,6 +134,11 @@ bool vhdl::semantic::binder::bind_package_declaration(
         ok &= bind_declarative_item(decl);
     }
 
+    // nothing is declared in a package after its declarative part. Until
+    // now, a use clause of this package, eg from a package it uses in turn,
+    // copies its named entities instead
+    current_region->seal_exports();
+
     close_declarative_region();
 
     return ok;
@@ -1035,10 +1040,17 @@ std::tuple<bool, vhdl::node::direct_visibility*> vhdl::semantic::binder::
     case vhdl::node::kind::library:
         break;
 
-    case vhdl::node::kind::package:
-        v->entities = d->as_package()->u->v.package.region->named_entities;
-        n->denotes = v->entities;
+    case vhdl::node::kind::package: {
+        auto region = d->as_package()->u->v.package.region;
+        v->exports = region->get_exports();
+        n->exports = v->exports;
+        if (!v->exports)
+        {
+            v->entities = region->named_entities;
+            n->denotes = region->named_entities;
+        }
         break;
+    }
 
     default:
         break;
@@ -1799,6 +1811,12 @@ std::vector<vhdl::node::named_entity*> vhdl::semantic::binder::lookup(
     {
         for (auto c : region->potentially_visible)
         {
+            if (c->exports)
+            {
+                c->exports->find(identifier, results);
+                continue;
+            }
+
             for (auto ne : c->entities)
             {
                 if (ne->get_identifier() != identifier)
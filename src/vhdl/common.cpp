@@ -8,6 +8,33 @@ vhdl::node::declarative_region::declarative_region(
     outer = parent;
 }
 
+std::shared_ptr<const vhdl::node::export_set>
+vhdl::node::declarative_region::get_exports() const
+{
+    return exports;
+}
+
+void vhdl::node::declarative_region::seal_exports()
+{
+    auto e = std::make_shared<vhdl::node::export_set>();
+    e->entities = named_entities;
+    e->by_identifier.reserve(named_entities.size());
+    for (auto ne : named_entities)
+        e->by_identifier[ne->get_identifier()].push_back(ne);
+
+    exports = std::move(e);
+}
+
+void vhdl::node::export_set::find(std::string_view identifier,
+                                  std::vector<named_entity*>& results) const
+{
+    auto it = by_identifier.find(identifier);
+    if (it == by_identifier.end())
+        return;
+
+    results.insert(results.end(), it->second.begin(), it->second.end());
+}
+
 vhdl::node::entity::entity(vhdl::syntax::design_unit* u)
     : identifier(u->v.entity.identifier.value), u(u)
 {
@@ -2,6 +2,11 @@
 #ifndef VHDL_COMMON_H
 #define VHDL_COMMON_H
 
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 // forward declarations
 namespace vhdl::node
 {
@@ -13,6 +18,23 @@ class package;
 class package_body;
 class declarative_region;
 class visitor;
+
+// Named entities exported by a declarative region, hashed by identifier. Used
+// by use clauses: one export set is built per package and is shared by every
+// use clause referring to it.
+struct export_set
+{
+    // in declaration order
+    std::vector<named_entity*> entities;
+
+    // the named entities of each identifier, in declaration order
+    std::unordered_map<std::string_view, std::vector<named_entity*>>
+        by_identifier;
+
+    // the named entities of an identifier, in declaration order, so that
+    // overloads are considered in the same order as without an export set
+    void find(std::string_view, std::vector<named_entity*>&) const;
+};
 }
 
 namespace vhdl::syntax
@@ -1,6 +1,8 @@
 
 #include "fast_parser.h"
 
+#include "common/trace.h"
+
 // ----------------------------------------------------------------------------
 // parser methods
 // ----------------------------------------------------------------------------
@@ -17,6 +19,8 @@ std::vector<std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
                        std::optional<std::string>, std::string, time_t>>
 vhdl::fast_parser::parse()
 {
+    TRACE_SPAN("fast_parser", lexer_.get_file());
+
     std::vector<
         std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
                    std::optional<std::string>, std::string, time_t>>
@@ -47,23 +51,44 @@ vhdl::fast_parser::parse()
         case tk::kw_configuration:
             unit = parse_configuration();
             break;
-        case tk::kw_library:
         case tk::kw_use:
+            parse_use_clause();
+            continue;
+        case tk::kw_context:
+            parse_context_clause();
+            continue;
+        case tk::kw_library:
             scan();
             [[fallthrough]];
         default:
             resync_to_next_unit();
+            continue;
         }
 
         if (unit)
         {
+            auto& [kind, line, column, identifier, identifier2, filename,
+                   timestamp] = unit.value();
+            start_unit(kind, identifier, identifier2);
             result.push_back(unit.value());
         }
+        else
+        {
+            // whatever follows belongs to no unit we know of
+            current_unit_.reset();
+            pending_.clear();
+        }
     }
 
     return result;
 }
 
+const std::vector<vhdl::dependency>&
+vhdl::fast_parser::get_dependencies() const
+{
+    return dependencies_;
+}
+
 std::optional<
     std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
                std::optional<std::string>, std::string, time_t>>
@@ -204,16 +229,17 @@ void vhdl::fast_parser::consume(token::kind_t token)
 
 void vhdl::fast_parser::resync_to_next_unit()
 {
+    // skip the current word
+    lexer_.scan();
+
     while (true)
     {
-        // skip the current word
-        lexer_.scan();
-
         switch (current_token()) {
         case tk::eof:
             return;
         case tk::kw_library:
         case tk::kw_use:
+        case tk::kw_context:
         case tk::kw_architecture:
         case tk::kw_entity:
         case tk::kw_package:
@@ -221,9 +247,243 @@ void vhdl::fast_parser::resync_to_next_unit()
             if (lexer_.previous_token() == tk::kw_end)
                 break;
             return; // this is the possible start of a new unit
+        case tk::colon:
+            // the entity or configuration of an instance is not a new unit
+            lexer_.scan();
+            parse_instantiation();
+            continue; // what follows the instance is not skipped
         case tk::semicolon:
         default:
             break;
         }
+
+        lexer_.scan();
+    }
+}
+
+// ----------------------------------------------------------------------------
+// dependencies
+// ----------------------------------------------------------------------------
+
+namespace
+{
+
+// the edge, from the given unit
+vhdl::dependency of(const vhdl::dependency& unit, vhdl::dependency&& edge)
+{
+    auto result = unit;
+    result.on = edge.on;
+    result.library = std::move(edge.library);
+    result.name = std::move(edge.name);
+    result.name2 = std::move(edge.name2);
+    return result;
+}
+
+}
+
+std::vector<std::string> vhdl::fast_parser::parse_name()
+{
+    std::vector<std::string> names;
+    if (current_token() != tk::identifier)
+        return names;
+
+    names.push_back(lexer_.get_identifier());
+    consume(tk::identifier);
+
+    while (current_token() == tk::dot)
+    {
+        consume(tk::dot);
+        if (current_token() != tk::identifier)
+            break;
+
+        names.push_back(lexer_.get_identifier());
+        consume(tk::identifier);
+    }
+
+    return names;
+}
+
+std::optional<std::string> vhdl::fast_parser::parse_architecture_suffix()
+{
+    if (current_token() != tk::leftpar)
+        return std::nullopt;
+
+    consume(tk::leftpar);
+    if (current_token() != tk::identifier)
+        return std::nullopt;
+
+    auto identifier = lexer_.get_identifier();
+    consume(tk::identifier);
+
+    if (current_token() == tk::rightpar)
+        consume(tk::rightpar);
+
+    return identifier;
+}
+
+void vhdl::fast_parser::parse_use_clause()
+{
+    consume(tk::kw_use);
+
+    // the binding indication of a configuration specification or of a
+    // component configuration. The rest of it is skipped by the caller
+    if (current_token() == tk::kw_entity ||
+        current_token() == tk::kw_configuration)
+    {
+        auto is_entity = current_token() == tk::kw_entity;
+        scan();
+
+        auto names = parse_name();
+        if (names.empty())
+            return;
+
+        auto library = names.size() > 1 ? std::optional(names[0]) : std::nullopt;
+        auto architecture =
+            is_entity ? parse_architecture_suffix() : std::nullopt;
+        depend(dependency_kind::binding, library, names.back(), architecture);
+        return;
+    }
+
+    parse_selected_names(dependency_kind::use);
+}
+
+void vhdl::fast_parser::parse_context_clause()
+{
+    consume(tk::kw_context);
+
+    // context c is: a context declaration, whose clauses are its own
+    if (current_token() == tk::identifier && lexer_.peek().kind == tk::kw_is)
+    {
+        current_unit_.reset();
+        pending_.clear();
+        return;
     }
+
+    parse_selected_names(dependency_kind::context);
+}
+
+void vhdl::fast_parser::parse_selected_names(dependency_kind on)
+{
+    while (true)
+    {
+        // lib.pkg.all names pkg in lib. pkg.all alone names no library unit
+        auto names = parse_name();
+        if (names.size() >= 2)
+            depend(on, names[0], names[1]);
+
+        while (current_token() != tk::comma &&
+               current_token() != tk::semicolon && current_token() != tk::eof)
+            scan();
+
+        if (current_token() != tk::comma)
+            break;
+        consume(tk::comma);
+    }
+
+    if (current_token() == tk::semicolon)
+        consume(tk::semicolon);
+
+    end_of_context_item();
+}
+
+void vhdl::fast_parser::parse_instantiation()
+{
+    switch (current_token())
+    {
+    case tk::kw_entity:
+    case tk::kw_configuration: {
+        auto is_entity = current_token() == tk::kw_entity;
+        scan();
+
+        auto names = parse_name();
+        if (names.empty())
+            return;
+
+        auto library = names.size() > 1 ? std::optional(names[0]) : std::nullopt;
+        auto architecture =
+            is_entity ? parse_architecture_suffix() : std::nullopt;
+        depend(dependency_kind::instantiation, library, names.back(),
+               architecture);
+        return;
+    }
+    case tk::kw_component: {
+        consume(tk::kw_component);
+
+        auto names = parse_name();
+        if (!names.empty())
+            depend(dependency_kind::instantiation, std::nullopt, names.back());
+        return;
+    }
+    case tk::identifier: {
+        // u : comp port map ... rather than s : std_logic;
+        auto names = parse_name();
+        if (current_token() == tk::kw_port || current_token() == tk::kw_generic)
+            depend(dependency_kind::instantiation, std::nullopt, names.back());
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+void vhdl::fast_parser::end_of_context_item()
+{
+    switch (current_token())
+    {
+    case tk::kw_library:
+    case tk::kw_use:
+    case tk::kw_context:
+    case tk::kw_entity:
+    case tk::kw_architecture:
+    case tk::kw_package:
+    case tk::kw_configuration:
+        return;
+    default:
+        break;
+    }
+
+    // a use clause in a declarative part, so of the current unit
+    if (current_unit_)
+        for (auto& d : pending_)
+            dependencies_.push_back(of(current_unit_.value(), std::move(d)));
+    pending_.clear();
+}
+
+void vhdl::fast_parser::start_unit(library_unit_kind kind,
+                                   const std::string& identifier,
+                                   const std::optional<std::string>& identifier2)
+{
+    dependency unit;
+    unit.kind = kind;
+    unit.identifier = identifier;
+    unit.identifier2 = identifier2;
+    unit.filename = std::string{lexer_.get_file()};
+    current_unit_ = std::move(unit);
+
+    // the context clause of this unit
+    for (auto& d : pending_)
+        dependencies_.push_back(of(current_unit_.value(), std::move(d)));
+    pending_.clear();
+}
+
+void vhdl::fast_parser::depend(dependency_kind on,
+                               std::optional<std::string> library,
+                               std::string name,
+                               std::optional<std::string> name2)
+{
+    dependency d;
+    d.on = on;
+    d.library = std::move(library);
+    d.name = std::move(name);
+    d.name2 = std::move(name2);
+
+    // which unit a context clause belongs to is only known after it
+    if (on == dependency_kind::use || on == dependency_kind::context)
+    {
+        pending_.push_back(std::move(d));
+        return;
+    }
+
+    if (current_unit_)
+        dependencies_.push_back(of(current_unit_.value(), std::move(d)));
 }
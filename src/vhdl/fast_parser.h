@@ -38,6 +38,13 @@ class fast_parser
                            std::optional<std::string>, std::string, time_t>>
     parse();
 
+    //
+    // The dependencies of the design units parse() found: the packages and
+    // contexts their context clauses use, and the units they instantiate or
+    // bind components to
+    //
+    const std::vector<dependency>& get_dependencies() const;
+
     private:
     std::optional<std::tuple<library_unit_kind, unsigned, unsigned, std::string,
                              std::optional<std::string>, std::string, time_t>>
@@ -82,6 +89,49 @@ class fast_parser
 
     void resync_to_next_unit();
 
+    // ------------------------------------------------------------------------
+    // Dependencies
+    // ------------------------------------------------------------------------
+
+    //
+    // a name, as in lib.pkg.item, up to the first part which is no identifier
+    //
+    std::vector<std::string> parse_name();
+
+    //
+    // the optional (architecture) after an entity name
+    //
+    std::optional<std::string> parse_architecture_suffix();
+
+    void parse_use_clause();
+    void parse_context_clause();
+
+    //
+    // the lib.unit, ... of a use clause or a context reference
+    //
+    void parse_selected_names(dependency_kind);
+
+    //
+    // after the colon of a label, which may be that of an instance
+    //
+    void parse_instantiation();
+
+    //
+    // a context clause precedes the unit it belongs to, unless it was a use
+    // clause in the middle of the current unit
+    //
+    void end_of_context_item();
+    void start_unit(library_unit_kind, const std::string&,
+                    const std::optional<std::string>&);
+
+    void depend(dependency_kind, std::optional<std::string>, std::string,
+                std::optional<std::string> = std::nullopt);
+
+    // the unit being scanned, if any
+    std::optional<dependency> current_unit_;
+    std::vector<dependency> pending_;
+    std::vector<dependency> dependencies_;
+
     vhdl::lexer lexer_;
 };
 
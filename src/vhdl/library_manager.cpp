@@ -1,10 +1,15 @@
 
 #include "library_manager.h"
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 #include <sstream>
 #include "sqlite3.h"
 
+#include "common/scope_guard.h"
+#include "common/trace.h"
+
 std::size_t id(vhdl::library_unit_kind kind, std::string identifier,
                std::optional<std::string> identifier2)
 {
@@ -30,6 +35,52 @@ std::size_t id(vhdl::library_unit_kind kind, std::string identifier,
     return h0 ^ (h2 << 1);
 }
 
+namespace
+{
+
+int design_unit_number(vhdl::library_unit_kind kind)
+{
+    switch (kind) {
+    case vhdl::library_unit_kind::entity:        return 1;
+    case vhdl::library_unit_kind::architecture:  return 2;
+    case vhdl::library_unit_kind::package:       return 3;
+    case vhdl::library_unit_kind::package_body:  return 4;
+    case vhdl::library_unit_kind::configuration: return 5;
+    default:                                     return 0;
+    }
+}
+
+vhdl::library_unit_kind design_unit_kind(int number)
+{
+    switch (number) {
+    case 1:  return vhdl::library_unit_kind::entity;
+    case 2:  return vhdl::library_unit_kind::architecture;
+    case 3:  return vhdl::library_unit_kind::package;
+    case 4:  return vhdl::library_unit_kind::package_body;
+    case 5:  return vhdl::library_unit_kind::configuration;
+    default: return vhdl::library_unit_kind::invalid;
+    }
+}
+
+// bind the text, or NULL, to a parameter of a prepared statement. The text is
+// copied, it does not have to outlive the statement
+int bind_text_or_null(sqlite3_stmt* stmt, int parameter,
+                      const std::optional<std::string>& s)
+{
+    if (!s)
+        return sqlite3_bind_null(stmt, parameter);
+    return sqlite3_bind_text(stmt, parameter, s->c_str(), -1, SQLITE_TRANSIENT);
+}
+
+std::optional<std::string> text_or_null(sqlite3_stmt* stmt, int column)
+{
+    if (sqlite3_column_type(stmt, column) == SQLITE_NULL)
+        return std::nullopt;
+    return std::string((const char*) sqlite3_column_text(stmt, column));
+}
+
+}
+
 vhdl::library_backend::library_backend(std::optional<std::string> location, std::string name, bool known)
 : location_(":memory:"), name_(name), is_valid_(true), is_known_(known), has_internal_problem_(false), db_(nullptr)
 {
@@ -83,6 +134,12 @@ std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
 vhdl::library_backend::get(std::string identifier,
                            std::optional<std::string> identifier2)
 {
+    TRACE_SPAN("sqlite get", identifier);
+    auto start = std::chrono::steady_clock::now();
+    auto timed = common::make_scope_guard([&]() {
+        get_statistics().queries.record(std::chrono::steady_clock::now() - start);
+    });
+
     vhdl::library_unit_kind kind = vhdl::library_unit_kind::invalid;
     unsigned line = 0;
     unsigned column = 0;
@@ -153,41 +210,64 @@ bool vhdl::library_backend::put(
 
     auto [kind, line, column, identifier, identifier2, filename, timestamp] =
         unit;
+    TRACE_SPAN("sqlite put", filename);
 
-    std::stringstream ss;
-    ss << "INSERT OR REPLACE INTO LIBRARY_UNITS (ID,LINENUMBER,TIMESTAMP,FILENAME,DESIGNUNIT,IDENTIFIER,IDENTIFIER2) VALUES (";
-    ss << id(kind, identifier, identifier2) << "," << line << "," << timestamp << ",'" << filename << "',";
-    switch (kind) {
-    case vhdl::library_unit_kind::entity:        ss << "1,'" << identifier << "',"  << "NULL";                          break;
-    case vhdl::library_unit_kind::architecture:  ss << "2,'" << identifier << "','" << identifier2.value_or("") << "'"; break;
-    case vhdl::library_unit_kind::package:       ss << "3,'" << identifier << "',"  << "NULL";                          break;
-    case vhdl::library_unit_kind::package_body:  ss << "4,'" << identifier << "',"  << "NULL";                          break;
-    case vhdl::library_unit_kind::configuration: ss << "5,'" << identifier << "','" << identifier2.value_or("") << "'"; break;
-    default:
+    int designunit = design_unit_number(kind);
+    if (designunit == 0)
+    {
         return false;
     }
-    ss << ");";
-    std::string sql(ss.str());
 
-    auto rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, nullptr);
-    
+    // only architectures and configurations store the entity they are of
+    if (kind != vhdl::library_unit_kind::architecture &&
+        kind != vhdl::library_unit_kind::configuration)
+        identifier2 = std::nullopt;
+    else if (!identifier2)
+        identifier2 = "";
+
+    auto sql = "INSERT OR REPLACE INTO LIBRARY_UNITS (ID,LINENUMBER,TIMESTAMP,FILENAME,DESIGNUNIT,IDENTIFIER,IDENTIFIER2) "
+               "VALUES (?1,?2,?3,?4,?5,?6,?7);";
+
+    sqlite3_stmt* stmt;
+    auto rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
     if (rc != SQLITE_OK)
     {
+        sqlite3_finalize(stmt);
         return false;
     }
 
+    // the id is bound as text, which the column converts the way it always
+    // converted the literal, so that the rows already stored are replaced
+    bind_text_or_null(stmt, 1, std::to_string(id(kind, identifier, identifier2)));
+    sqlite3_bind_int(stmt, 2, line);
+    sqlite3_bind_int64(stmt, 3, timestamp);
+    bind_text_or_null(stmt, 4, filename);
+    sqlite3_bind_int(stmt, 5, designunit);
+    bind_text_or_null(stmt, 6, identifier);
+    bind_text_or_null(stmt, 7, identifier2);
+
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        return false;
+    }
+
+    get_statistics().writes++;
     return true;
 }
 
 void vhdl::library_backend::clear()
 {
+    TRACE_SPAN("sqlite clear", name_);
+
     if (!connected_and_tables_exists())
     {
         return;
     }
 
     // Create SQL statement
-    auto sql = "DELETE from LIBRARY_UNITS;";
+    auto sql = "DELETE from LIBRARY_UNITS; DELETE from DEPENDENCIES;";
 
     // Execute SQL statement
     auto rc = sqlite3_exec(db_, sql, nullptr, nullptr, nullptr);
@@ -200,22 +280,64 @@ void vhdl::library_backend::clear()
 std::vector<std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
                        std::optional<std::string>, std::string, time_t>>
 vhdl::library_backend::all(int limit, std::optional<std::string> filter)
+{
+    std::stringstream ss;
+    if (filter) ss << " WHERE IDENTIFIER=?1 OR IDENTIFIER2=?1";
+    if (limit != 0) ss << " LIMIT " << limit;
+    return select_units(ss.str(), filter);
+}
+
+std::vector<std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
+                       std::optional<std::string>, std::string, time_t>>
+vhdl::library_backend::in_file(const std::string& filename)
+{
+    return select_units(" WHERE FILENAME=?1", filename);
+}
+
+void vhdl::library_backend::forget_units(const std::string& filename)
+{
+    if (!connected_and_tables_exists())
+    {
+        return;
+    }
+
+    auto sql = "DELETE from LIBRARY_UNITS where FILENAME=?1;";
+
+    sqlite3_stmt* stmt;
+    auto rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if (rc == SQLITE_OK)
+    {
+        bind_text_or_null(stmt, 1, filename);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        // there's nothing we can do
+    }
+}
+
+std::vector<std::tuple<vhdl::library_unit_kind, unsigned, unsigned, std::string,
+                       std::optional<std::string>, std::string, time_t>>
+vhdl::library_backend::select_units(
+    const std::string& where, const std::optional<std::string>& parameter)
 {
     std::vector<std::tuple<library_unit_kind, unsigned, unsigned, std::string,
                            std::optional<std::string>, std::string, time_t>>
         result;
+    TRACE_SPAN("sqlite all", name_);
+    auto start = std::chrono::steady_clock::now();
+    auto timed = common::make_scope_guard([&]() {
+        get_statistics().queries.record(std::chrono::steady_clock::now() - start);
+    });
+
     if (!connected_and_tables_exists())
     {
         return result;
     }
 
     // build the sql statement
-    std::stringstream ss;
-    ss << "SELECT * from LIBRARY_UNITS";
-    if (filter) ss << " WHERE IDENTIFIER='" << filter.value() << "' OR IDENTIFIER2='" << filter.value() << "'";
-    if (limit != 0) ss << " LIMIT " << limit;
-    ss << " ;";
-    std::string sql(ss.str());
+    std::string sql = "SELECT * from LIBRARY_UNITS" + where + " ;";
 
     // compile sql statement to binary
     sqlite3_stmt* stmt;
@@ -226,6 +348,9 @@ vhdl::library_backend::all(int limit, std::optional<std::string> filter)
         return result;
     }
 
+    if (parameter)
+        bind_text_or_null(stmt, 1, parameter);
+
     // execute sql statement
     bool found = false;
     while((rc = sqlite3_step(stmt)) == SQLITE_ROW)
@@ -268,6 +393,149 @@ vhdl::library_backend::all(int limit, std::optional<std::string> filter)
     return result;
 }
 
+bool vhdl::library_backend::put(const dependency& d)
+{
+    if (!connected_and_tables_exists())
+    {
+        return false;
+    }
+
+    auto designunit = design_unit_number(d.kind);
+    if (designunit == 0)
+    {
+        return false;
+    }
+
+    auto sql = "INSERT INTO DEPENDENCIES (FILENAME,DESIGNUNIT,IDENTIFIER,IDENTIFIER2,KIND,LIBRARY,NAME,NAME2) "
+               "VALUES (?1,?2,?3,?4,?5,?6,?7,?8);";
+
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if (rc != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    bind_text_or_null(stmt, 1, d.filename);
+    sqlite3_bind_int(stmt, 2, designunit);
+    bind_text_or_null(stmt, 3, d.identifier);
+    bind_text_or_null(stmt, 4, d.identifier2);
+    sqlite3_bind_int(stmt, 5, static_cast<int>(d.on));
+    bind_text_or_null(stmt, 6, d.library);
+    bind_text_or_null(stmt, 7, d.name);
+    bind_text_or_null(stmt, 8, d.name2);
+
+    rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        return false;
+    }
+
+    get_statistics().writes++;
+    return true;
+}
+
+void vhdl::library_backend::forget_dependencies(const std::string& filename)
+{
+    if (!connected_and_tables_exists())
+    {
+        return;
+    }
+
+    auto sql = "DELETE from DEPENDENCIES where FILENAME=?1;";
+
+    sqlite3_stmt* stmt;
+    auto rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    if (rc == SQLITE_OK)
+    {
+        bind_text_or_null(stmt, 1, filename);
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE)
+    {
+        // there's nothing we can do
+    }
+}
+
+std::vector<vhdl::dependency>
+vhdl::library_backend::dependencies(std::optional<std::string> identifier)
+{
+    if (identifier)
+        return select_dependencies(" WHERE IDENTIFIER=?1", identifier);
+    return select_dependencies("");
+}
+
+std::vector<vhdl::dependency>
+vhdl::library_backend::dependents(const std::string& name)
+{
+    return select_dependencies(" WHERE NAME=?1", name);
+}
+
+std::vector<vhdl::dependency>
+vhdl::library_backend::select_dependencies(
+    const std::string& where, const std::optional<std::string>& parameter)
+{
+    std::vector<dependency> result;
+    TRACE_SPAN("sqlite dependencies", name_);
+    auto start = std::chrono::steady_clock::now();
+    auto timed = common::make_scope_guard([&]() {
+        get_statistics().queries.record(std::chrono::steady_clock::now() - start);
+    });
+
+    if (!connected_and_tables_exists())
+    {
+        return result;
+    }
+
+    std::string sql = "SELECT * from DEPENDENCIES" + where + " ;";
+
+    // compile sql statement to binary
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return result;
+    }
+
+    if (parameter)
+        bind_text_or_null(stmt, 1, parameter);
+
+    // execute sql statement
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        dependency d;
+        d.filename    = std::string((const char*) sqlite3_column_text(stmt, 0));
+        d.kind        = design_unit_kind(sqlite3_column_int(stmt, 1));
+        d.identifier  = std::string((const char*) sqlite3_column_text(stmt, 2));
+        d.identifier2 = text_or_null(stmt, 3);
+        d.on          = static_cast<dependency_kind>(sqlite3_column_int(stmt, 4));
+        d.library     = text_or_null(stmt, 5);
+        d.name        = std::string((const char*) sqlite3_column_text(stmt, 6));
+        d.name2       = text_or_null(stmt, 7);
+        result.push_back(std::move(d));
+    }
+
+    //release resources
+    sqlite3_finalize(stmt);
+
+    return result;
+}
+
+vhdl::library_backend::statistics& vhdl::library_backend::get_statistics()
+{
+    static statistics stats;
+    return stats;
+}
+
+std::int64_t vhdl::library_backend::get_memory_used()
+{
+    return sqlite3_memory_used();
+}
+
 
 bool vhdl::library_backend::connected_and_tables_exists()
 {
@@ -290,7 +558,19 @@ bool vhdl::library_backend::connected_and_tables_exists()
                "FILENAME       TEXT NOT NULL," \
                "DESIGNUNIT     INT  NOT NULL," \
                "IDENTIFIER     TEXT NOT NULL," \
-               "IDENTIFIER2    TEXT);";
+               "IDENTIFIER2    TEXT);" \
+               "CREATE TABLE IF NOT EXISTS DEPENDENCIES (" \
+               "FILENAME       TEXT NOT NULL," \
+               "DESIGNUNIT     INT  NOT NULL," \
+               "IDENTIFIER     TEXT NOT NULL," \
+               "IDENTIFIER2    TEXT," \
+               "KIND           INT  NOT NULL," \
+               "LIBRARY        TEXT," \
+               "NAME           TEXT NOT NULL," \
+               "NAME2          TEXT);" \
+               "CREATE INDEX IF NOT EXISTS DEPENDENCIES_BY_NAME ON DEPENDENCIES (NAME);" \
+               "CREATE INDEX IF NOT EXISTS DEPENDENCIES_BY_FILENAME ON DEPENDENCIES (FILENAME);" \
+               "CREATE INDEX IF NOT EXISTS DEPENDENCIES_BY_IDENTIFIER ON DEPENDENCIES (IDENTIFIER);";
 
     // Execute SQL statement
     rc = sqlite3_exec(db_, sql, nullptr, nullptr, nullptr);
@@ -331,6 +611,39 @@ void vhdl::library_manager::initialise(std::vector<std::string> names)
     }
 }
 
+void vhdl::library_manager::update(const std::vector<std::string>& names)
+{
+    std::unique_lock g(mtx_);
+    for (auto it = lbe_.begin(); it != lbe_.end();)
+    {
+        // libraries the project does not define come and go as they are used
+        auto& lbe = it->second;
+        if (lbe->is_known() &&
+            std::find(names.begin(), names.end(), it->first) == names.end())
+        {
+            lbe->is_valid_ = false;
+            it = lbe_.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    for (auto& name: names)
+    {
+        auto it = lbe_.find(name);
+        if (it == lbe_.end())
+        {
+            auto lbe = std::make_shared<vhdl::library_backend>(location_, name, true);
+            lbe_.insert(std::make_pair(name, lbe));
+        }
+        else if (!it->second->is_known())
+        {
+            // it was used before the project defined it
+            it->second->is_known_ = true;
+        }
+    }
+}
+
 void vhdl::library_manager::destroy()
 {
     std::unique_lock g(mtx_);
@@ -3,6 +3,7 @@
 #define VHDL_LIBRARY_MANAGER_H
 
 #include <atomic>
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
 #include <optional>
@@ -10,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "common/histogram.h"
 #include "common/serialize.h"
 
 // forward declaration
@@ -28,6 +30,32 @@ enum class library_unit_kind
     configuration
 };
 
+// What a library unit depends on another for
+enum class dependency_kind
+{
+    use,           // use lib.pkg.all;
+    context,       // context lib.ctx;
+    instantiation, // u : entity lib.e(a), u : configuration lib.c, u : comp
+    binding        // for u : comp use entity lib.e(a);
+};
+
+// An edge of the dependency graph of a project: a library unit, and the unit
+// it names. The library of the unit named is as written, eg "work", and is
+// missing for a component, which is bound by name. name2 is the architecture
+// an entity is instantiated or bound with, if any
+struct dependency
+{
+    library_unit_kind kind;
+    std::string identifier;
+    std::optional<std::string> identifier2;
+    std::string filename;
+
+    dependency_kind on;
+    std::optional<std::string> library;
+    std::string name;
+    std::optional<std::string> name2;
+};
+
 class library_manager;
 
 // sqlite library backend that interfaces with the sqlite database. Frontends
@@ -45,6 +73,11 @@ class library_manager;
 //  library_backend::clear()
 //  library_backend::all()
 //
+// The backend also stores the dependencies the indexer found between library
+// units, and looks them up both ways:
+//  library_backend::dependencies() what the units of a name depend on
+//  library_backend::dependents()   which units depend on a name
+//
 //
 // A library backend has validity. Validity depends on whether the library
 // manager has disowned the library manager.
@@ -68,6 +101,7 @@ class library_backend
 
     std::string get_location();
     std::string get_name();
+
     bool is_valid();
     bool is_known();
     bool has_internal_problem();
@@ -85,9 +119,50 @@ class library_backend
                            std::optional<std::string>, std::string, time_t>>
     all(int = 0, std::optional<std::string> = std::nullopt);
 
+    // the units found in a file, and dropping them before the file is indexed
+    // again or once it is gone
+    std::vector<std::tuple<library_unit_kind, unsigned, unsigned, std::string,
+                           std::optional<std::string>, std::string, time_t>>
+    in_file(const std::string&);
+    void forget_units(const std::string&);
+
+    bool put(const dependency&);
+
+    // drop the dependencies found in a file, before it is indexed again
+    void forget_dependencies(const std::string&);
+
+    // the dependencies of the units with the given identifier, or of every
+    // unit
+    std::vector<dependency>
+        dependencies(std::optional<std::string> = std::nullopt);
+
+    // the dependencies naming the given unit
+    std::vector<dependency> dependents(const std::string&);
+
+    // Counters shared by all the library backends
+    struct statistics
+    {
+        common::histogram queries; // get() and all()
+        std::atomic<std::uint64_t> writes = 0;
+    };
+
+    static statistics& get_statistics();
+
+    // bytes of memory currently used by sqlite, for all the libraries
+    static std::int64_t get_memory_used();
+
     private:
     bool connected_and_tables_exists();
 
+    // the where clauses may use ?1, bound to the parameter
+    std::vector<std::tuple<library_unit_kind, unsigned, unsigned, std::string,
+                           std::optional<std::string>, std::string, time_t>>
+    select_units(const std::string&,
+                 const std::optional<std::string>& = std::nullopt);
+    std::vector<dependency>
+    select_dependencies(const std::string&,
+                        const std::optional<std::string>& = std::nullopt);
+
     std::string location_;
     std::string name_;
     bool has_internal_problem_;
@@ -121,6 +196,11 @@ class library_manager
     ~library_manager() = default;
 
     void initialise(std::vector<std::string>);
+
+    // Be aware of these libraries from now on. The ones already known keep
+    // what they hold, the others are dropped, and the new ones start empty
+    void update(const std::vector<std::string>&);
+
     void destroy();
     std::vector<std::string> list();
 
@@ -0,0 +1,267 @@
+
+#include "vhdl/outline.h"
+
+#include "vhdl_syntax.h"
+
+std::size_t vhdl::outline::open()
+{
+    symbols.push_back({});
+    symbols.back().depth = depth++;
+    opened.push_back(symbols.size() - 1);
+    return symbols.size() - 1;
+}
+
+void vhdl::outline::leave()
+{
+    --depth;
+    opened.pop_back();
+}
+
+void vhdl::outline::close(std::size_t h, vhdl::syntax::design_unit* u)
+{
+    leave();
+
+    if (!u)
+        return discard(h);
+
+    switch (u->v_kind) {
+    case vhdl::syntax::design_unit::v_::entity: {
+        auto& e = u->v.entity;
+        set(h, kind::entity, e.identifier, u->first__, u->__last);
+        foldable(e.gl__, e.__gr);
+        foldable(e.pl__, e.__pr);
+    }   break;
+
+    case vhdl::syntax::design_unit::v_::architecture: {
+        auto& a = u->v.architecture;
+        set(h, kind::architecture, a.identifier, u->first__, u->__last);
+        foldable(a.is__, a.__begin__);
+        foldable(a.__begin__, a.__end);
+    }   break;
+
+    case vhdl::syntax::design_unit::v_::package: {
+        auto& p = u->v.package;
+        set(h, kind::package, p.identifier, u->first__, u->__last);
+        foldable(p.is__, p.__end);
+    }   break;
+
+    case vhdl::syntax::design_unit::v_::package_body: {
+        auto& p = u->v.package_body;
+        set(h, kind::package_body, p.identifier, u->first__, u->__last);
+        foldable(p.is__, p.__end);
+    }   break;
+
+    case vhdl::syntax::design_unit::v_::configuration: {
+        auto& c = u->v.configuration;
+        set(h, kind::configuration, c.identifier, u->first__, u->__last);
+        foldable(c.is__, c.__end);
+    }   break;
+
+    default:
+        discard(h);
+        break;
+    }
+}
+
+void vhdl::outline::close(std::size_t h, vhdl::syntax::declarative_item* d)
+{
+    leave();
+
+    if (!d)
+        return discard(h);
+
+    switch (d->v_kind) {
+    case vhdl::syntax::declarative_item::v_::type:
+        set(h, kind::type, d->v.type.identifier, d->first__, d->__last);
+        break;
+
+    case vhdl::syntax::declarative_item::v_::subtype:
+        set(h, kind::subtype, d->v.subtype.identifier, d->first__, d->__last);
+        break;
+
+    case vhdl::syntax::declarative_item::v_::alias:
+        set(h, kind::alias, d->v.alias.designator, d->first__, d->__last);
+        break;
+
+    // one symbol per identifier. Objects have no children, so the symbol we
+    // opened is the last one
+    case vhdl::syntax::declarative_item::v_::object:
+        discard(h);
+        for (auto& it: d->v.object.v->identifier)
+            add(kind::object, it, d->first__, d->__last);
+        break;
+
+    case vhdl::syntax::declarative_item::v_::interface:
+        discard(h);
+        for (auto& it: d->v.interface.v->identifier)
+            add(kind::interface, it, d->first__, d->__last);
+        break;
+
+    case vhdl::syntax::declarative_item::v_::component: {
+        auto& c = d->v.component;
+        set(h, kind::component, c.identifier, d->first__, d->__last);
+        foldable(c.pl__, c.__pr);
+        foldable(c.gl__, c.__gr);
+    }   break;
+
+    case vhdl::syntax::declarative_item::v_::subprogram: {
+        auto& s = d->v.subprogram;
+        auto k = s.spec->v_kind == vhdl::syntax::subprogram::v_::function
+                     ? kind::function
+                     : kind::procedure;
+        set(h, k, s.spec->designator, d->first__, d->__last);
+        foldable(s.pl__, s.__pr);
+    }   break;
+
+    case vhdl::syntax::declarative_item::v_::subprogram_body: {
+        auto& s = d->v.subprogram_body;
+        auto k = s.spec->v_kind == vhdl::syntax::subprogram::v_::function
+                     ? kind::function
+                     : kind::procedure;
+        set(h, k, s.spec->designator, d->first__, d->__last);
+        foldable(s.pl__, s.__pr);
+        foldable(s.is__, s.__begin__);
+        foldable(s.__begin__, s.__end);
+    }   break;
+
+    default:
+        discard(h);
+        break;
+    }
+}
+
+void vhdl::outline::close(std::size_t h, vhdl::syntax::concurrent_statement* c)
+{
+    leave();
+
+    if (!c)
+        return discard(h);
+
+    switch (c->v_kind) {
+    case vhdl::syntax::concurrent_statement::v_::process: {
+        auto& p = c->v.process;
+        foldable(p.process__, p.__begin__);
+        foldable(p.__begin__, p.__end);
+
+        if (!c->label)
+            return discard(h);
+
+        set(h, kind::process, *c->label, c->first__, c->__last);
+    }   break;
+
+    // the generic and port maps have no children. Add them after the instance
+    case vhdl::syntax::concurrent_statement::v_::inst: {
+        auto& i = c->v.inst;
+        foldable(i.gl__, i.__gr);
+        foldable(i.pl__, i.__pr);
+
+        if (!c->label)
+            return discard(h);
+
+        set(h, kind::instance, *c->label, c->first__, c->__last);
+        ++depth;
+        if (i.generic__ && i.gl__ && i.__gr)
+            close(open(), kind::generic_map, *i.generic__, *i.__gr);
+        if (i.port__ && i.pl__ && i.__pr)
+            close(open(), kind::port_map, *i.port__, *i.__pr);
+        --depth;
+    }   break;
+
+    // blocks and generate statements are not part of the outline, and neither
+    // is what they contain
+    default:
+        discard(h);
+        break;
+    }
+}
+
+void vhdl::outline::close(std::size_t h, kind k, const common::location& first,
+                          const common::location& last)
+{
+    leave();
+
+    auto& s = symbols[h];
+    s.k = k;
+    switch (k) {
+    case kind::generics:    s.name = "generic";     break;
+    case kind::ports:       s.name = "port";        break;
+    case kind::generic_map: s.name = "generic map"; break;
+    case kind::port_map:    s.name = "port map";    break;
+    default:
+        break;
+    }
+    s.selection_begin = first.begin;
+    s.selection_end = first.end;
+    s.begin = first.begin;
+    s.end = last.end;
+}
+
+void vhdl::outline::library(const std::vector<vhdl::token>& names)
+{
+    for (auto& it: names)
+        add(kind::library, it, it.location, it.location);
+}
+
+void vhdl::outline::fold(vhdl::syntax::sequential_statement* s)
+{
+    switch (s->v_kind) {
+    case vhdl::syntax::sequential_statement::v_::if_stmt:
+        foldable(s->v.if_stmt.then__, s->v.if_stmt.__end);
+        break;
+    case vhdl::syntax::sequential_statement::v_::for_loop:
+        foldable(s->v.for_loop.loop__, s->v.for_loop.__end);
+        break;
+    case vhdl::syntax::sequential_statement::v_::while_loop:
+        foldable(s->v.while_loop.loop__, s->v.while_loop.__end);
+        break;
+    default:
+        break;
+    }
+}
+
+void vhdl::outline::abort()
+{
+    // innermost first, so that the handles of the others stay valid
+    for (auto h = opened.rbegin(); h != opened.rend(); ++h)
+    {
+        symbols.erase(symbols.begin() + *h);
+        for (auto it = symbols.begin() + *h; it != symbols.end(); ++it)
+            --it->depth;
+    }
+
+    opened.clear();
+    depth = 0;
+}
+
+void vhdl::outline::set(std::size_t h, kind k, const vhdl::token& name,
+                        const common::location& first,
+                        const common::location& last)
+{
+    auto& s = symbols[h];
+    s.k = k;
+    s.name = name.value;
+    s.selection_begin = name.location.begin;
+    s.selection_end = name.location.end;
+    s.begin = first.begin;
+    s.end = last.end;
+}
+
+void vhdl::outline::add(kind k, const vhdl::token& name,
+                        const common::location& first,
+                        const common::location& last)
+{
+    symbols.push_back({});
+    symbols.back().depth = depth;
+    set(symbols.size() - 1, k, name, first, last);
+}
+
+void vhdl::outline::discard(std::size_t h)
+{
+    symbols.resize(h);
+}
+
+void vhdl::outline::foldable(const common::location& from,
+                             const common::location& to)
+{
+    folds.push_back({from.end, to.begin});
+}
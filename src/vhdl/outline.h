@@ -0,0 +1,128 @@
+
+#ifndef VHDL_OUTLINE_H
+#define VHDL_OUTLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "common/location.h"
+#include "vhdl/common.h"
+
+namespace vhdl
+{
+
+// forward declaration
+class token;
+
+// An outline is the structure of a design file as an editor shows it: the
+// symbols it declares (design units, declarations, processes, instances...)
+// and the regions that can be folded.
+//
+// The parser collects the outline as a side product of parsing, so that
+// document symbols and folding ranges are a copy of two arrays instead of a
+// traversal of the syntax tree.
+//
+// Symbols are stored in pre-order along with their depth: the children of a
+// symbol are the symbols following it with a greater depth. The parser opens
+// a symbol when it starts parsing a construct, so that the symbols found
+// while parsing it become its children. The symbol is closed, and filled in,
+// once the construct is parsed. A construct which turns out to declare no
+// symbol is dropped together with its children.
+class outline
+{
+    public:
+    enum class kind: std::uint8_t
+    {
+        // design units and library clauses
+        entity, architecture, package, package_body, configuration, library,
+
+        // generic and port clauses, generic and port maps
+        generics, ports, generic_map, port_map,
+
+        // declarations
+        type, subtype, alias, component, function, procedure, object,
+        interface,
+
+        // concurrent statements
+        process, instance,
+    };
+
+    struct symbol
+    {
+        kind k;
+        std::uint32_t depth;
+        std::string_view name;
+
+        // the name of the symbol
+        common::position selection_begin;
+        common::position selection_end;
+
+        // the whole construct declaring the symbol
+        common::position begin;
+        common::position end;
+    };
+
+    // A region that can be folded, from the end of a keyword or parenthesis to
+    // the beginning of the matching end keyword or parenthesis
+    struct region
+    {
+        common::position from;
+        common::position to;
+    };
+
+    const std::vector<symbol>& get_symbols() const { return symbols; }
+    const std::vector<region>& get_folds() const { return folds; }
+
+    // Open a symbol and return its handle
+    std::size_t open();
+
+    // Close a symbol given its handle and the construct that was parsed. A
+    // nullptr means that the construct was not parsed successfully
+    void close(std::size_t, vhdl::syntax::design_unit*);
+    void close(std::size_t, vhdl::syntax::declarative_item*);
+    void close(std::size_t, vhdl::syntax::concurrent_statement*);
+
+    // Close a symbol grouping the generics or the ports of a clause
+    void close(std::size_t, kind, const common::location&,
+               const common::location&);
+
+    // Add the names of a library clause
+    void library(const std::vector<vhdl::token>&);
+
+    // Sequential statements declare no symbols, but loops and if statements
+    // can be folded
+    void fold(vhdl::syntax::sequential_statement*);
+
+    // Drop the symbols that are still open, eg when parsing was aborted. They
+    // were never filled in. What they contain so far is kept, one level up
+    void abort();
+
+    private:
+    void set(std::size_t, kind, const vhdl::token&, const common::location&,
+             const common::location&);
+    void add(kind, const vhdl::token&, const common::location&,
+             const common::location&);
+    void discard(std::size_t);
+    void leave();
+
+    void foldable(const common::location&, const common::location&);
+    template <typename T>
+    void foldable(const T& from, const T& to)
+    {
+        if (from && to)
+            foldable(*from, *to);
+    }
+
+    std::vector<symbol> symbols;
+    std::vector<region> folds;
+    std::uint32_t depth = 0;
+
+    // handles of the symbols opened and not closed yet, outermost first
+    std::vector<std::size_t> opened;
+};
+
+}
+
+#endif
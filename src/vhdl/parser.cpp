@@ -5,6 +5,7 @@
 
 #include "parser.h"
 #include "common/scope_guard.h"
+#include "common/trace.h"
 
 namespace Err
 {
@@ -134,6 +135,11 @@ vhdl::parser::~parser()
 
 }
 
+void vhdl::parser::collect_outline(vhdl::outline* o)
+{
+    outline_ = o;
+}
+
 // ----------------------------------------------------------------------------
 // parser methods
 // ----------------------------------------------------------------------------
@@ -144,6 +150,8 @@ vhdl::parser::~parser()
 std::tuple<bool, std::vector<common::diagnostic>>
 vhdl::parser::operator()()
 {
+    TRACE_SPAN("parse", file_->filename);
+
     try
     {
         auto ok = parse_design_file();
@@ -154,6 +162,10 @@ vhdl::parser::operator()()
         diag(Err::Parser_encountered_a_problem);
     }
 
+    // keep what was found before the problem
+    if (outline_)
+        outline_->abort();
+
     return std::make_tuple(false, std::move(diagnostics));
 }
 
@@ -218,6 +230,8 @@ std::tuple<common::location, common::location,
            std::vector<vhdl::syntax::declarative_item*>, common::location>
 vhdl::parser::parse_generic_clause()
 {
+    auto symbol = open_outline();
+
     auto generic__ = eat(tk::kw_generic);
     auto gl__ = eat(tk::leftpar);
 
@@ -226,6 +240,9 @@ vhdl::parser::parse_generic_clause()
     auto __gr = eat(tk::rightpar);
     consume(tk::semicolon);
 
+    if (outline_)
+        outline_->close(symbol, vhdl::outline::kind::generics, generic__, __gr);
+
     return std::make_tuple(generic__, gl__, result, __gr);
 }
 
@@ -233,6 +250,8 @@ std::tuple<common::location, common::location,
            std::vector<vhdl::syntax::declarative_item*>, common::location>
 vhdl::parser::parse_port_clause()
 {
+    auto symbol = open_outline();
+
     auto port__ = eat(tk::kw_port);
     auto pl__ = eat(tk::leftpar);
 
@@ -241,6 +260,9 @@ vhdl::parser::parse_port_clause()
     auto __pr = eat(tk::rightpar);
     consume(tk::semicolon);
 
+    if (outline_)
+        outline_->close(symbol, vhdl::outline::kind::ports, port__, __pr);
+
     return std::make_tuple(port__, pl__, result, __pr);
 }
 
@@ -272,6 +294,7 @@ vhdl::syntax::concurrent_statement* vhdl::parser::parse_entity_statement()
     const auto secnd = peek(has_label ? 3 : 1);
 
     auto first__ = lexer_.get_current_location();
+    auto symbol = open_outline();
 
     vhdl::syntax::concurrent_statement* result = nullptr;
     switch (first) {
@@ -303,12 +326,12 @@ vhdl::syntax::concurrent_statement* vhdl::parser::parse_entity_statement()
     }
 
     if (!result)
-        return nullptr;
+        return close_outline(symbol, result);
 
     result->first__ = first__;
     result->__last = lexer_.get_previous_location();
 
-    return result;
+    return close_outline(symbol, result);
 }
 
 vhdl::syntax::design_unit* vhdl::parser::parse_architecture_body()
@@ -1438,6 +1461,7 @@ vhdl::parser::parse_declarative_item(declarative_part kind)
     std::unique_ptr<vhdl::syntax::declarative_item> throw_away;
 
     auto first__ = lexer_.get_current_location();
+    auto symbol = open_outline();
 
     switch (current_token()) {
     case tk::kw_type:
@@ -1708,11 +1732,11 @@ vhdl::parser::parse_declarative_item(declarative_part kind)
     auto __last = lexer_.get_previous_location();
 
     if (!result)
-        return nullptr;
+        return close_outline(symbol, result);
 
     result->first__ = first__;
     result->__last = __last;
-    return result;
+    return close_outline(symbol, result);
 }
 
 vhdl::syntax::declarative_item* vhdl::parser::parse_type_declaration()
@@ -2033,6 +2057,7 @@ vhdl::syntax::declarative_item* vhdl::parser::parse_interface_element(
     std::unique_ptr<vhdl::syntax::declarative_item> throw_away;
 
     auto first__ = lexer_.get_current_location();
+    auto symbol = open_outline();
 
     switch (current_token()) {
     case tk::kw_constant:
@@ -2165,11 +2190,11 @@ vhdl::syntax::declarative_item* vhdl::parser::parse_interface_element(
     }
 
     if (!result)
-        return nullptr;
+        return close_outline(symbol, result);
 
     result->first__ = first__;
     result->__last = lexer_.get_previous_location();
-    return result;
+    return close_outline(symbol, result);
 }
 
 vhdl::syntax::declarative_item*
@@ -3772,6 +3797,9 @@ vhdl::syntax::sequential_statement* vhdl::parser::parse_sequential_statement()
     if (!result)
         return nullptr;
 
+    if (outline_)
+        outline_->fold(result);
+
     // result->first__ = first__;
     // result->__last = lexer_.get_previous_location();
 
@@ -4403,6 +4431,8 @@ vhdl::syntax::concurrent_statement* vhdl::parser::parse_concurrent_statement()
                               .depth = 0};
     const bool there_is_a_signal_assignment = lexer_.look_for(that);
 
+    auto symbol = open_outline();
+
     vhdl::syntax::concurrent_statement* result = nullptr;
     switch (first) {
     case tk::identifier:
@@ -4468,12 +4498,12 @@ vhdl::syntax::concurrent_statement* vhdl::parser::parse_concurrent_statement()
     }
 
     if (!result)
-        return nullptr;
+        return close_outline(symbol, result);
 
     result->first__ = first__;
     result->__last = lexer_.get_previous_location();
 
-    return result;
+    return close_outline(symbol, result);
 }
 
 vhdl::syntax::concurrent_statement* vhdl::parser::parse_block_statement()
@@ -5100,6 +5130,7 @@ bool vhdl::parser::parse_design_file()
 vhdl::syntax::design_unit* vhdl::parser::parse_design_unit()
 {
     auto contexts = parse_context_clause();
+    auto symbol = open_outline();
 
     vhdl::syntax::design_unit* unit = nullptr;
     switch (current_token()) {
@@ -5124,10 +5155,10 @@ vhdl::syntax::design_unit* vhdl::parser::parse_design_unit()
     }
 
     if (!unit)
-        return nullptr;
+        return close_outline(symbol, unit);
 
     unit->contexts = contexts;
-    return unit;
+    return close_outline(symbol, unit);
 }
 
 vhdl::syntax::context_item* vhdl::parser::parse_library_clause()
@@ -5168,6 +5199,9 @@ vhdl::syntax::context_item* vhdl::parser::parse_library_clause()
         return nullptr;
     }
 
+    if (outline_)
+        outline_->library(result->v.library_clause.names);
+
     return result.release();
 }
 
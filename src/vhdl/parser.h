@@ -11,6 +11,7 @@
 #include "common/diagnostics.h"
 
 #include "lexer.h"
+#include "outline.h"
 #include "token.h"
 
 #include "vhdl_syntax.h"
@@ -101,6 +102,11 @@ class parser
     parser(common::stringtable*, vhdl::syntax::design_file*, version = vhdl93);
     ~parser();
 
+    //
+    // Collect the outline of the file while parsing it. Off by default
+    //
+    void collect_outline(vhdl::outline*);
+
     // ------------------------------------------------------------------------
     // Parser methods
     // ------------------------------------------------------------------------
@@ -1701,9 +1707,25 @@ class parser
         return result;
     }
 
+    // Open and close a symbol of the outline, if one is being collected. The
+    // symbols found in between are the children of the symbol
+    std::size_t open_outline()
+    {
+        return outline_ ? outline_->open() : 0;
+    }
+
+    template <typename T>
+    T* close_outline(std::size_t symbol, T* node)
+    {
+        if (outline_)
+            outline_->close(symbol, node);
+        return node;
+    }
+
     vhdl::syntax::design_file* file_;
     vhdl::lexer lexer_;
     std::vector<common::diagnostic> diagnostics;
+    vhdl::outline* outline_ = nullptr;
 
     version version_ = vhdl93;
 };
@@ -0,0 +1,106 @@
+
+#include "vhdl/position_index.h"
+
+#include <algorithm>
+
+#include "vhdl_syntax.h"
+
+namespace
+{
+
+// Collect the locations of every syntax node that has one. The order of the
+// traversal does not follow the source text (eg the ports of an entity come
+// after its declarations), so the intervals are sorted afterwards
+class interval_collector: public vhdl::syntax::visitor
+{
+    public:
+    using vhdl::syntax::visitor::visit;
+
+    bool visit(vhdl::syntax::design_unit* u) override
+    {
+        add(u->first__, u->__last, u);
+        return true;
+    }
+
+    bool visit(vhdl::syntax::declarative_item* d) override
+    {
+        add(d->first__, d->__last, d);
+        return true;
+    }
+
+    bool visit(vhdl::syntax::concurrent_statement* c) override
+    {
+        add(c->first__, c->__last, c);
+        return true;
+    }
+
+    std::vector<vhdl::position_index::interval> intervals;
+
+    private:
+    void add(const common::location& first, const common::location& last,
+             vhdl::position_index::node n)
+    {
+        intervals.push_back({first.begin, last.end,
+                             vhdl::position_index::npos, n});
+    }
+};
+
+}
+
+vhdl::position_index::position_index(vhdl::syntax::design_file* file)
+{
+    if (!file)
+        return;
+
+    interval_collector c;
+    file->traverse_static(c);
+    intervals.swap(c.intervals);
+
+    // outer intervals first when two of them begin at the same position
+    std::sort(intervals.begin(), intervals.end(),
+              [](const interval& lhs, const interval& rhs) {
+                  if (lhs.begin != rhs.begin)
+                      return lhs.begin < rhs.begin;
+                  return lhs.end > rhs.end;
+              });
+
+    // link each interval to the innermost interval containing it
+    std::vector<std::size_t> enclosing;
+    for (std::size_t i = 0; i < intervals.size(); ++i)
+    {
+        while (enclosing.size() &&
+               intervals[enclosing.back()].end < intervals[i].begin)
+            enclosing.pop_back();
+
+        intervals[i].parent = enclosing.size() ? enclosing.back() : npos;
+        enclosing.push_back(i);
+    }
+}
+
+const vhdl::position_index::interval*
+vhdl::position_index::find(const common::position& position) const
+{
+    // the last interval beginning at or before the position. Either it
+    // contains the position, or one of its ancestors does, or none does
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), position,
+                               [](const common::position& p, const interval& i) {
+                                   return p < i.begin;
+                               });
+    if (it == intervals.begin())
+        return nullptr;
+
+    const interval* i = &*(it - 1);
+    while (i && i->end < position)
+        i = parent(i);
+
+    return i;
+}
+
+const vhdl::position_index::interval*
+vhdl::position_index::parent(const interval* i) const
+{
+    if (!i || i->parent == npos)
+        return nullptr;
+
+    return &intervals[i->parent];
+}
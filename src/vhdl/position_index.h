@@ -0,0 +1,59 @@
+
+#ifndef VHDL_POSITION_INDEX_H
+#define VHDL_POSITION_INDEX_H
+
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+#include "common/position.h"
+#include "vhdl/common.h"
+
+namespace vhdl
+{
+
+// A position index maps a position in a design file to the innermost syntax
+// node enclosing it. Only nodes with begin and end locations are indexed:
+// design units, declarative items and concurrent statements.
+//
+// The index is a vector of intervals sorted by begin position. Syntax nodes
+// nest, so the intervals do too and each interval links to the interval of
+// its enclosing node. A lookup is a binary search followed by a short walk up
+// the parent links. Following the parent links from the result gives the path
+// from the innermost node up to its design unit.
+class position_index
+{
+    public:
+    using node = std::variant<vhdl::syntax::design_unit*,
+                              vhdl::syntax::declarative_item*,
+                              vhdl::syntax::concurrent_statement*>;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct interval
+    {
+        common::position begin;
+        common::position end;
+        std::size_t parent;
+        node syntax;
+    };
+
+    position_index() = default;
+    explicit position_index(vhdl::syntax::design_file*);
+
+    // Return the innermost interval containing the position, or nullptr if
+    // the position lies outside of any design unit (eg in a context clause)
+    const interval* find(const common::position&) const;
+
+    // Return the interval of the enclosing node, or nullptr for design units
+    const interval* parent(const interval*) const;
+
+    std::size_t size() const { return intervals.size(); }
+
+    private:
+    std::vector<interval> intervals;
+};
+
+}
+
+#endif
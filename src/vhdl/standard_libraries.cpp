@@ -0,0 +1,13 @@
+
+#include "standard_libraries.h"
+
+const vhdl::stdlib::embedded_file*
+vhdl::stdlib::find(std::string_view library, std::string_view identifier)
+{
+    for (std::size_t i = 0; i < number_of_files; ++i)
+    {
+        if (files[i].library == library && files[i].identifier == identifier)
+            return &files[i];
+    }
+    return nullptr;
+}
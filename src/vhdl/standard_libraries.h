@@ -0,0 +1,39 @@
+
+#ifndef VHDL_STANDARD_LIBRARIES_H
+#define VHDL_STANDARD_LIBRARIES_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace vhdl
+{
+
+// The std and ieee libraries are the same for every project. Their sources are
+// embedded in the executable at build time (see scripts/embed_stdlib.py), so
+// that they never need to be listed in the project configuration nor be found
+// on disk.
+namespace stdlib
+{
+
+struct embedded_file
+{
+    std::string_view library;
+    std::string_view identifier; // primary unit declared by this file
+    std::string_view filename;
+    std::string_view text;
+};
+
+// generated by scripts/embed_stdlib.py
+extern const embedded_file files[];
+extern const std::size_t number_of_files;
+
+// Find the embedded file which declares the primary unit library.identifier.
+// Returns nullptr if there is no such file
+const embedded_file* find(std::string_view library,
+                          std::string_view identifier);
+
+}
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+-- Package NUMERIC_BIT as defined in IEEE Std 1076.3-1997.
+--
+-- This is the declaration of the package only. The package body is not needed
+-- by the language server.
+
+package numeric_bit is
+
+    type unsigned is array ( natural range <> ) of bit;
+    type signed   is array ( natural range <> ) of bit;
+
+    -- arithmetic operators
+    function "abs" ( arg : signed ) return signed;
+    function "-"   ( arg : signed ) return signed;
+
+    function "+" ( l, r : unsigned ) return unsigned;
+    function "+" ( l, r : signed ) return signed;
+    function "+" ( l : unsigned; r : natural ) return unsigned;
+    function "+" ( l : natural; r : unsigned ) return unsigned;
+    function "+" ( l : integer; r : signed ) return signed;
+    function "+" ( l : signed; r : integer ) return signed;
+
+    function "-" ( l, r : unsigned ) return unsigned;
+    function "-" ( l, r : signed ) return signed;
+    function "-" ( l : unsigned; r : natural ) return unsigned;
+    function "-" ( l : natural; r : unsigned ) return unsigned;
+    function "-" ( l : integer; r : signed ) return signed;
+    function "-" ( l : signed; r : integer ) return signed;
+
+    function "*" ( l, r : unsigned ) return unsigned;
+    function "*" ( l, r : signed ) return signed;
+    function "*" ( l : unsigned; r : natural ) return unsigned;
+    function "*" ( l : natural; r : unsigned ) return unsigned;
+    function "*" ( l : integer; r : signed ) return signed;
+    function "*" ( l : signed; r : integer ) return signed;
+
+    function "/" ( l, r : unsigned ) return unsigned;
+    function "/" ( l, r : signed ) return signed;
+    function "/" ( l : unsigned; r : natural ) return unsigned;
+    function "/" ( l : natural; r : unsigned ) return unsigned;
+    function "/" ( l : integer; r : signed ) return signed;
+    function "/" ( l : signed; r : integer ) return signed;
+
+    function "rem" ( l, r : unsigned ) return unsigned;
+    function "rem" ( l, r : signed ) return signed;
+    function "rem" ( l : unsigned; r : natural ) return unsigned;
+    function "rem" ( l : natural; r : unsigned ) return unsigned;
+    function "rem" ( l : integer; r : signed ) return signed;
+    function "rem" ( l : signed; r : integer ) return signed;
+
+    function "mod" ( l, r : unsigned ) return unsigned;
+    function "mod" ( l, r : signed ) return signed;
+    function "mod" ( l : unsigned; r : natural ) return unsigned;
+    function "mod" ( l : natural; r : unsigned ) return unsigned;
+    function "mod" ( l : integer; r : signed ) return signed;
+    function "mod" ( l : signed; r : integer ) return signed;
+
+    -- comparison operators
+    function ">" ( l, r : unsigned ) return boolean;
+    function ">" ( l, r : signed ) return boolean;
+    function ">" ( l : natural; r : unsigned ) return boolean;
+    function ">" ( l : integer; r : signed ) return boolean;
+    function ">" ( l : unsigned; r : natural ) return boolean;
+    function ">" ( l : signed; r : integer ) return boolean;
+
+    function "<" ( l, r : unsigned ) return boolean;
+    function "<" ( l, r : signed ) return boolean;
+    function "<" ( l : natural; r : unsigned ) return boolean;
+    function "<" ( l : integer; r : signed ) return boolean;
+    function "<" ( l : unsigned; r : natural ) return boolean;
+    function "<" ( l : signed; r : integer ) return boolean;
+
+    function "<=" ( l, r : unsigned ) return boolean;
+    function "<=" ( l, r : signed ) return boolean;
+    function "<=" ( l : natural; r : unsigned ) return boolean;
+    function "<=" ( l : integer; r : signed ) return boolean;
+    function "<=" ( l : unsigned; r : natural ) return boolean;
+    function "<=" ( l : signed; r : integer ) return boolean;
+
+    function ">=" ( l, r : unsigned ) return boolean;
+    function ">=" ( l, r : signed ) return boolean;
+    function ">=" ( l : natural; r : unsigned ) return boolean;
+    function ">=" ( l : integer; r : signed ) return boolean;
+    function ">=" ( l : unsigned; r : natural ) return boolean;
+    function ">=" ( l : signed; r : integer ) return boolean;
+
+    function "=" ( l, r : unsigned ) return boolean;
+    function "=" ( l, r : signed ) return boolean;
+    function "=" ( l : natural; r : unsigned ) return boolean;
+    function "=" ( l : integer; r : signed ) return boolean;
+    function "=" ( l : unsigned; r : natural ) return boolean;
+    function "=" ( l : signed; r : integer ) return boolean;
+
+    function "/=" ( l, r : unsigned ) return boolean;
+    function "/=" ( l, r : signed ) return boolean;
+    function "/=" ( l : natural; r : unsigned ) return boolean;
+    function "/=" ( l : integer; r : signed ) return boolean;
+    function "/=" ( l : unsigned; r : natural ) return boolean;
+    function "/=" ( l : signed; r : integer ) return boolean;
+
+    -- shift and rotate functions
+    function shift_left ( arg : unsigned; count : natural ) return unsigned;
+    function shift_left ( arg : signed; count : natural ) return signed;
+    function shift_right ( arg : unsigned; count : natural ) return unsigned;
+    function shift_right ( arg : signed; count : natural ) return signed;
+    function rotate_left ( arg : unsigned; count : natural ) return unsigned;
+    function rotate_left ( arg : signed; count : natural ) return signed;
+    function rotate_right ( arg : unsigned; count : natural ) return unsigned;
+    function rotate_right ( arg : signed; count : natural ) return signed;
+
+    function "sll" ( arg : unsigned; count : integer ) return unsigned;
+    function "sll" ( arg : signed; count : integer ) return signed;
+    function "srl" ( arg : unsigned; count : integer ) return unsigned;
+    function "srl" ( arg : signed; count : integer ) return signed;
+    function "rol" ( arg : unsigned; count : integer ) return unsigned;
+    function "rol" ( arg : signed; count : integer ) return signed;
+    function "ror" ( arg : unsigned; count : integer ) return unsigned;
+    function "ror" ( arg : signed; count : integer ) return signed;
+
+    -- resize functions
+    function resize ( arg : signed; new_size : natural ) return signed;
+    function resize ( arg : unsigned; new_size : natural ) return unsigned;
+
+    -- conversion functions
+    function to_integer  ( arg : unsigned ) return natural;
+    function to_integer  ( arg : signed ) return integer;
+    function to_unsigned ( arg, size : natural ) return unsigned;
+    function to_signed   ( arg : integer; size : natural ) return signed;
+
+    -- logical operators
+    function "not" ( l : unsigned ) return unsigned;
+    function "not" ( l : signed ) return signed;
+    function "and" ( l, r : unsigned ) return unsigned;
+    function "and" ( l, r : signed ) return signed;
+    function "or" ( l, r : unsigned ) return unsigned;
+    function "or" ( l, r : signed ) return signed;
+    function "nand" ( l, r : unsigned ) return unsigned;
+    function "nand" ( l, r : signed ) return signed;
+    function "nor" ( l, r : unsigned ) return unsigned;
+    function "nor" ( l, r : signed ) return signed;
+    function "xor" ( l, r : unsigned ) return unsigned;
+    function "xor" ( l, r : signed ) return signed;
+    function "xnor" ( l, r : unsigned ) return unsigned;
+    function "xnor" ( l, r : signed ) return signed;
+
+    -- edge detection
+    function rising_edge  ( signal s : bit ) return boolean;
+    function falling_edge ( signal s : bit ) return boolean;
+
+end numeric_bit;
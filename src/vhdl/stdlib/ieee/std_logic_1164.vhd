@@ -0,0 +1,111 @@
+-- Package STD_LOGIC_1164 as defined in IEEE Std 1164-1993.
+--
+-- This is the declaration of the package only. The package body is not needed
+-- by the language server.
+
+package std_logic_1164 is
+
+    -- logic state system (unresolved)
+    type std_ulogic is ( 'U',  -- uninitialized
+                         'X',  -- forcing unknown
+                         '0',  -- forcing 0
+                         '1',  -- forcing 1
+                         'Z',  -- high impedance
+                         'W',  -- weak unknown
+                         'L',  -- weak 0
+                         'H',  -- weak 1
+                         '-'   -- don't care
+                       );
+
+    -- unconstrained array of std_ulogic for use with the resolution function
+    type std_ulogic_vector is array ( natural range <> ) of std_ulogic;
+
+    -- resolution function
+    function resolved ( s : std_ulogic_vector ) return std_ulogic;
+
+    -- *** industry standard logic type ***
+    subtype std_logic is resolved std_ulogic;
+
+    -- unconstrained array of std_logic for use in declaring signal arrays
+    type std_logic_vector is array ( natural range <>) of std_logic;
+
+    -- common subtypes
+    subtype x01     is resolved std_ulogic range 'X' to '1'; -- ('X','0','1')
+    subtype x01z    is resolved std_ulogic range 'X' to 'Z'; -- ('X','0','1','Z')
+    subtype ux01    is resolved std_ulogic range 'U' to '1'; -- ('U','X','0','1')
+    subtype ux01z   is resolved std_ulogic range 'U' to 'Z'; -- ('U','X','0','1','Z')
+
+    -- overloaded logical operators
+    function "and"  ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "nand" ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "or"   ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "nor"  ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "xor"  ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "xnor" ( l : std_ulogic; r : std_ulogic ) return ux01;
+    function "not"  ( l : std_ulogic                 ) return ux01;
+
+    -- vectorized overloaded logical operators
+    function "and"  ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "and"  ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "nand" ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "nand" ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "or"   ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "or"   ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "nor"  ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "nor"  ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "xor"  ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "xor"  ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "xnor" ( l, r : std_logic_vector  ) return std_logic_vector;
+    function "xnor" ( l, r : std_ulogic_vector ) return std_ulogic_vector;
+
+    function "not"  ( l : std_logic_vector  ) return std_logic_vector;
+    function "not"  ( l : std_ulogic_vector ) return std_ulogic_vector;
+
+    -- conversion functions
+    function to_bit       ( s : std_ulogic;        xmap : bit := '0') return bit;
+    function to_bitvector ( s : std_logic_vector ; xmap : bit := '0') return bit_vector;
+    function to_bitvector ( s : std_ulogic_vector; xmap : bit := '0') return bit_vector;
+
+    function to_stdulogic       ( b : bit               ) return std_ulogic;
+    function to_stdlogicvector  ( b : bit_vector        ) return std_logic_vector;
+    function to_stdlogicvector  ( s : std_ulogic_vector ) return std_logic_vector;
+    function to_stdulogicvector ( b : bit_vector        ) return std_ulogic_vector;
+    function to_stdulogicvector ( s : std_logic_vector  ) return std_ulogic_vector;
+
+    -- strength strippers and type convertors
+    function to_x01  ( s : std_logic_vector  ) return std_logic_vector;
+    function to_x01  ( s : std_ulogic_vector ) return std_ulogic_vector;
+    function to_x01  ( s : std_ulogic        ) return x01;
+    function to_x01  ( b : bit_vector        ) return std_logic_vector;
+    function to_x01  ( b : bit_vector        ) return std_ulogic_vector;
+    function to_x01  ( b : bit               ) return x01;
+
+    function to_x01z ( s : std_logic_vector  ) return std_logic_vector;
+    function to_x01z ( s : std_ulogic_vector ) return std_ulogic_vector;
+    function to_x01z ( s : std_ulogic        ) return x01z;
+    function to_x01z ( b : bit_vector        ) return std_logic_vector;
+    function to_x01z ( b : bit_vector        ) return std_ulogic_vector;
+    function to_x01z ( b : bit               ) return x01z;
+
+    function to_ux01 ( s : std_logic_vector  ) return std_logic_vector;
+    function to_ux01 ( s : std_ulogic_vector ) return std_ulogic_vector;
+    function to_ux01 ( s : std_ulogic        ) return ux01;
+    function to_ux01 ( b : bit_vector        ) return std_logic_vector;
+    function to_ux01 ( b : bit_vector        ) return std_ulogic_vector;
+    function to_ux01 ( b : bit               ) return ux01;
+
+    -- edge detection
+    function rising_edge  ( signal s : std_ulogic ) return boolean;
+    function falling_edge ( signal s : std_ulogic ) return boolean;
+
+    -- object contains an unknown
+    function is_x ( s : std_ulogic_vector ) return boolean;
+    function is_x ( s : std_logic_vector  ) return boolean;
+    function is_x ( s : std_ulogic        ) return boolean;
+
+end std_logic_1164;
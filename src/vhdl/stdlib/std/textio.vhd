@@ -0,0 +1,73 @@
+-- Package TEXTIO as defined in IEEE Std 1076-1993, section 14.3.
+--
+-- This is the declaration of the package only. The package body is not needed
+-- by the language server.
+
+package textio is
+
+    type line is access string;
+
+    type text is file of string;
+
+    type side is (right, left);
+
+    subtype width is natural;
+
+    file input  : text open read_mode  is "STD_INPUT";
+    file output : text open write_mode is "STD_OUTPUT";
+
+    procedure readline (file f : text; l : inout line);
+
+    procedure read (l : inout line; value : out bit; good : out boolean);
+    procedure read (l : inout line; value : out bit);
+
+    procedure read (l : inout line; value : out bit_vector; good : out boolean);
+    procedure read (l : inout line; value : out bit_vector);
+
+    procedure read (l : inout line; value : out boolean; good : out boolean);
+    procedure read (l : inout line; value : out boolean);
+
+    procedure read (l : inout line; value : out character; good : out boolean);
+    procedure read (l : inout line; value : out character);
+
+    procedure read (l : inout line; value : out integer; good : out boolean);
+    procedure read (l : inout line; value : out integer);
+
+    procedure read (l : inout line; value : out real; good : out boolean);
+    procedure read (l : inout line; value : out real);
+
+    procedure read (l : inout line; value : out string; good : out boolean);
+    procedure read (l : inout line; value : out string);
+
+    procedure read (l : inout line; value : out time; good : out boolean);
+    procedure read (l : inout line; value : out time);
+
+    procedure writeline (file f : text; l : inout line);
+
+    procedure write (l : inout line; value : in bit;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in bit_vector;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in boolean;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in character;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in integer;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in real;
+                     justified : in side := right; field : in width := 0;
+                     digits : in natural := 0);
+
+    procedure write (l : inout line; value : in string;
+                     justified : in side := right; field : in width := 0);
+
+    procedure write (l : inout line; value : in time;
+                     justified : in side := right; field : in width := 0;
+                     unit : in time := ns);
+
+end textio;
@@ -7,6 +7,8 @@
 #include "loguru.h"
 
 #include "version.h"
+#include "common/trace.h"
+#include "lsp/benchmark.h"
 #include "things/language.h"
 
 using arg_it = std::vector<std::string>::const_iterator;
@@ -28,6 +30,8 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> t(parser, "path"   , "write trace to this file",   {     "trace"});
     args::ValueFlag<std::string> j(parser, "path"   , "write journal to this file", {     "journal"});
     args::ValueFlag<std::string> r(parser, "path"   , "replay this journal file",   {     "replay"});
+    args::ValueFlag<std::string> b(parser, "path"   , "replay this journal file as fast as possible and report latencies", {"replay-bench"});
+    args::ValueFlag<std::string> o(parser, "path"   , "write the benchmark report as json to this file", {"bench-json"});
 
     int status = 0;
     try
@@ -55,6 +59,15 @@ int main(int argc, char** argv)
                              loguru::Verbosity_MAX);
         }
 
+        if (t && common::trace::start(get(t)))
+        {
+            LOG_S(INFO) << "Writing trace to " << get(t);
+        }
+        else if (t)
+        {
+            LOG_S(ERROR) << "Unable to write trace to " << get(t);
+        }
+
         if (v)
         {
             LOG_S(INFO) << "Vhdlstuff " << things::build_hash << " (" << things::build_branch << ") " << things::build_tag;
@@ -70,6 +83,21 @@ int main(int argc, char** argv)
 
             connection.print_status();
         }
+        else if (b)
+        {
+            lsp::benchmark connection(args::get(b));
+            {
+            things::language server(&connection);
+            server.run();
+            }
+
+            connection.print_report(std::cout);
+            if (o && !connection.write_report(args::get(o)))
+            {
+                LOG_S(ERROR) << "Unable to write benchmark report to " << get(o);
+                status = 1;
+            }
+        }
         else
         {
         lsp::stdio connection;
@@ -128,6 +156,7 @@ int main(int argc, char** argv)
         status = 1;
     }
 
+    common::trace::stop();
     return status;
 }
 
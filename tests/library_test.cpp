@@ -4,3 +4,444 @@
 #include "vhdl/library_manager.h"
 
 
+#include "vhdl/ast.h"
+#include "vhdl/fast_parser.h"
+#include "vhdl/outline.h"
+#include "vhdl/parser.h"
+#include "vhdl/position_index.h"
+
+#include <algorithm>
+
+TEST_CASE("std and ieee resolve without any library on disk", "[stdlib]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree("", manager, "work");
+
+    auto empty = tree.get_memory_estimate();
+
+    auto units = tree.load_primary_unit("ieee", "numeric_std", std::nullopt);
+    REQUIRE(units.size() == 1);
+    REQUIRE(units[0]->state == vhdl::node::library_unit_state::analysed);
+
+    // the units loaded from the embedded libraries are accounted for
+    REQUIRE(tree.get_memory_estimate() > empty + units[0]->file->src.size());
+
+    // numeric_std uses std_logic_1164, which must have come along
+    REQUIRE(tree.load_primary_unit("ieee", "std_logic_1164", std::nullopt)
+                .size() == 1);
+    REQUIRE(tree.load_primary_unit("std", "textio", std::nullopt).size() == 1);
+
+    REQUIRE(tree.load_primary_unit("ieee", "not_a_package", std::nullopt)
+                .empty());
+}
+
+TEST_CASE("the embedded standard has every character of ISO 8859-1",
+          "[stdlib]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree("", manager, "work");
+
+    auto units = tree.load_primary_unit("std", "standard", std::nullopt);
+    REQUIRE(units.size() == 1);
+    REQUIRE(units[0]->state == vhdl::node::library_unit_state::analysed);
+
+    auto unit = units[0]->syntax;
+    REQUIRE(unit->v_kind == vhdl::syntax::design_unit::v_::package);
+
+    std::vector<std::string_view> characters;
+    for (auto item : unit->v.package.decls)
+        if (item->v_kind == vhdl::syntax::declarative_item::v_::type &&
+            item->v.type.identifier.value == "character")
+            for (auto& literal : item->v.type.type->v.enumeration.literals)
+                characters.push_back(literal.value);
+
+    REQUIRE(characters.size() == 256);
+    REQUIRE(characters[127] == "del");
+    REQUIRE(characters[159] == "c159");
+    REQUIRE(characters[160] == "'\xA0'");
+    REQUIRE(characters[255] == "'\xFF'");
+}
+
+TEST_CASE("position index finds the innermost node", "[position_index]")
+{
+    std::string text = "library ieee;\n"
+                       "entity e is\n"
+                       "end entity;\n"
+                       "architecture a of e is\n"
+                       "  signal s : bit;\n"
+                       "begin\n"
+                       "  p: process\n"
+                       "    variable v : bit;\n"
+                       "  begin\n"
+                       "    v := s;\n"
+                       "  end process;\n"
+                       "end architecture;\n";
+
+    common::stringtable strings;
+    auto file = std::make_shared<vhdl::syntax::design_file>();
+    file->src.assign(text.begin(), text.end());
+    vhdl::parser parse(&strings, file.get());
+    parse();
+
+    vhdl::position_index index(file.get());
+    REQUIRE(index.size() == 5);
+
+    // the context clause is not part of any design unit
+    REQUIRE(index.find(common::position(1, 3)) == nullptr);
+
+    auto s = index.find(common::position(5, 10));
+    REQUIRE(s);
+    REQUIRE(std::holds_alternative<vhdl::syntax::declarative_item*>(s->syntax));
+    REQUIRE(std::holds_alternative<vhdl::syntax::design_unit*>(
+        index.parent(s)->syntax));
+
+    // v is declared in a process, within an architecture
+    auto v = index.find(common::position(8, 14));
+    REQUIRE(v);
+    REQUIRE(std::holds_alternative<vhdl::syntax::declarative_item*>(v->syntax));
+    auto p = index.parent(v);
+    REQUIRE(std::holds_alternative<vhdl::syntax::concurrent_statement*>(p->syntax));
+    REQUIRE(index.parent(index.parent(p)) == nullptr);
+
+    // statements of a process are not indexed: the process encloses them
+    REQUIRE(index.find(common::position(10, 5)) == p);
+
+    // in between units, and past the end of the file
+    REQUIRE(index.find(common::position(3, 12))->begin.line == 2);
+    REQUIRE(index.find(common::position(13, 1)) == nullptr);
+}
+
+TEST_CASE("the parser collects the outline of a file", "[outline]")
+{
+    std::string text = "library ieee;\n"
+                       "entity e is\n"
+                       "  port (a, b : in bit);\n"
+                       "end entity;\n"
+                       "architecture a of e is\n"
+                       "  signal s : bit;\n"
+                       "begin\n"
+                       "  p: process\n"
+                       "    variable v : bit;\n"
+                       "  begin\n"
+                       "    if s = '1' then\n"
+                       "      v := s;\n"
+                       "    end if;\n"
+                       "  end process;\n"
+                       "  process\n"
+                       "    variable hidden : bit;\n"
+                       "  begin\n"
+                       "  end process;\n"
+                       "end architecture;\n";
+
+    common::stringtable strings;
+    auto file = std::make_shared<vhdl::syntax::design_file>();
+    file->src.assign(text.begin(), text.end());
+    vhdl::outline outline;
+    vhdl::parser parse(&strings, file.get());
+    parse.collect_outline(&outline);
+    parse();
+
+    using kind = vhdl::outline::kind;
+    std::vector<std::tuple<kind, std::uint32_t, std::string_view>> symbols;
+    for (auto& it : outline.get_symbols())
+        symbols.emplace_back(it.k, it.depth, it.name);
+
+    // unlabelled processes are not part of the outline, and neither are their
+    // declarations
+    REQUIRE(symbols == decltype(symbols){
+                           {kind::library, 0, "ieee"},
+                           {kind::entity, 0, "e"},
+                           {kind::ports, 1, "port"},
+                           {kind::interface, 2, "a"},
+                           {kind::interface, 2, "b"},
+                           {kind::architecture, 0, "a"},
+                           {kind::object, 1, "s"},
+                           {kind::process, 1, "p"},
+                           {kind::object, 2, "v"},
+                       });
+
+    // the port clause, the architecture (2), both processes (2 each) and the
+    // if statement
+    REQUIRE(outline.get_folds().size() == 8);
+}
+
+TEST_CASE("an aborted outline keeps what was closed", "[outline]")
+{
+    using kind = vhdl::outline::kind;
+    common::location clause(common::position(2, 3), common::position(2, 7));
+    common::location parenthesis(common::position(2, 20),
+                                 common::position(2, 21));
+
+    // the parser gave up in the middle of the entity, after its port clause
+    vhdl::outline outline;
+    outline.open();
+    outline.close(outline.open(), kind::ports, clause, parenthesis);
+    outline.open();
+    outline.abort();
+
+    REQUIRE(outline.get_symbols().size() == 1);
+    REQUIRE(outline.get_symbols()[0].k == kind::ports);
+    REQUIRE(outline.get_symbols()[0].depth == 0);
+
+    // and starts from scratch afterwards
+    outline.close(outline.open(), kind::ports, clause, parenthesis);
+    REQUIRE(outline.get_symbols()[1].depth == 0);
+}
+
+TEST_CASE("an ast parses the text it is given instead of the file",
+          "[ast]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree("not_on_disk.vhd", manager, "work");
+
+    tree.update();
+    REQUIRE(tree.get_main_file() == nullptr);
+    REQUIRE_FALSE(tree.get_main_file_text_version().has_value());
+
+    tree.set_main_file_text("entity e is\nend entity;\n", 3);
+    REQUIRE_FALSE(tree.update());
+    REQUIRE(tree.get_main_file() != nullptr);
+    REQUIRE(tree.get_main_file_text_version() == 3);
+    REQUIRE(tree.get_outline().get_symbols().size() == 1);
+    REQUIRE(tree.get_outline().get_symbols()[0].name == "e");
+}
+
+TEST_CASE("a snapshot is not changed by the next update", "[ast]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree("not_on_disk.vhd", manager, "work");
+
+    tree.set_main_file_text("entity e is\nend entity;\n", 1);
+    tree.update();
+    auto before = tree.get_snapshot();
+
+    tree.set_main_file_text("entity f is\nend entity;\n"
+                            "entity g is\nend entity;\n", 2);
+    tree.update();
+    auto after = tree.get_snapshot();
+
+    REQUIRE(before != after);
+    REQUIRE(before->text_version == 1);
+    REQUIRE(before->main_file->units.size() == 1);
+    REQUIRE(before->units.size() == 1);
+    REQUIRE(before->units[0]->syntax == before->main_file->units[0]);
+    REQUIRE(before->outline.get_symbols().size() == 1);
+    REQUIRE(before->outline.get_symbols()[0].name == "e");
+    REQUIRE(before->positions.find({1, 8}) != nullptr);
+
+    REQUIRE(after->text_version == 2);
+    REQUIRE(after->outline.get_symbols().size() == 2);
+    REQUIRE(after->main_file_version == tree.get_main_file_version());
+    REQUIRE(after->main_file_version != before->main_file_version);
+}
+
+TEST_CASE("parsing the main file again replaces its cached units", "[ast]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    vhdl::ast tree("not_on_disk.vhd", manager, "work");
+
+    std::string text = "entity e is\nend entity;\n"
+                       "architecture a of e is\nbegin\nend architecture;\n";
+    tree.set_main_file_text(text, 0);
+    tree.update();
+    auto estimate = tree.get_memory_estimate();
+
+    std::weak_ptr<vhdl::node::library_unit> first = tree.get_snapshot()->units[0];
+    for (int version = 1; version <= 10; ++version)
+    {
+        tree.set_main_file_text(text, version);
+        tree.update();
+        REQUIRE(tree.get_memory_estimate() == estimate);
+    }
+
+    // nothing but the snapshot of the time held the first parse
+    REQUIRE(first.expired());
+    REQUIRE(tree.get_snapshot()->units.size() == 2);
+}
+
+TEST_CASE("the neighbours of a file are the units it instantiates", "[ast]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    manager->initialise({"lib"});
+
+    auto lib = manager->get("lib");
+    using kind = vhdl::library_unit_kind;
+    lib->put({kind::entity, 1, 1, "child", std::nullopt, "child.vhd", 0});
+    lib->put({kind::architecture, 1, 1, "rtl", "child", "child_rtl.vhd", 0});
+    lib->put({kind::entity, 1, 1, "other", std::nullopt, "other.vhd", 0});
+
+    vhdl::ast tree("top.vhd", manager, "lib");
+    tree.set_main_file_text("entity top is\n"
+                            "end entity;\n"
+                            "architecture a of top is\n"
+                            "begin\n"
+                            "  u: entity work.child;\n"
+                            "  g: if true generate\n"
+                            "    v: entity lib.child;\n"
+                            "  end generate;\n"
+                            "end architecture;\n", 1);
+    tree.update();
+
+    auto files = tree.get_neighbour_files(8);
+    std::sort(files.begin(), files.end());
+    REQUIRE(files == std::vector<std::string>{"child.vhd", "child_rtl.vhd"});
+
+    REQUIRE(tree.get_neighbour_files(1).size() == 1);
+}
+
+TEST_CASE("the fast parser finds what each unit depends on", "[fast_parser]")
+{
+    std::string text = "library ieee;\n"
+                       "use ieee.std_logic_1164.all, work.p.all;\n"
+                       "entity top is\n"
+                       "  port (clk : in std_logic);\n"
+                       "end entity;\n"
+                       "architecture a of top is\n"
+                       "  use work.q.all;\n"
+                       "  signal s : std_logic;\n"
+                       "  for u2 : comp use entity lib.child(rtl);\n"
+                       "begin\n"
+                       "  u1: entity work.child(rtl) port map (clk => clk);\n"
+                       "  u2: comp port map (clk => clk);\n"
+                       "  u3: configuration lib.cfg;\n"
+                       "end architecture;\n"
+                       "context lib.ctx;\n"
+                       "package p is\n"
+                       "end package;\n";
+
+    common::stringtable strings;
+    vhdl::fast_parser fast(&strings, &text[0], &text[text.size()], "top.vhd");
+    auto units = fast.parse();
+    REQUIRE(units.size() == 3);
+
+    std::vector<std::tuple<std::string, vhdl::dependency_kind,
+                           std::optional<std::string>, std::string,
+                           std::optional<std::string>>>
+        edges;
+    for (auto& d : fast.get_dependencies())
+    {
+        REQUIRE(d.filename == "top.vhd");
+        edges.emplace_back(d.identifier, d.on, d.library, d.name, d.name2);
+    }
+
+    using on = vhdl::dependency_kind;
+    REQUIRE(edges == decltype(edges){
+        {"top", on::use, "ieee", "std_logic_1164", std::nullopt},
+        {"top", on::use, "work", "p", std::nullopt},
+        {"a", on::use, "work", "q", std::nullopt},
+        {"a", on::binding, "lib", "child", "rtl"},
+        {"a", on::instantiation, "work", "child", "rtl"},
+        {"a", on::instantiation, std::nullopt, "comp", std::nullopt},
+        {"a", on::instantiation, "lib", "cfg", std::nullopt},
+        {"p", on::context, "lib", "ctx", std::nullopt},
+    });
+
+    // the edges are stored in the library and found both ways
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    manager->initialise({"lib"});
+    auto lib = manager->get("lib");
+    for (auto& d : fast.get_dependencies())
+        REQUIRE(lib->put(d));
+
+    auto of_a = lib->dependencies("a");
+    REQUIRE(of_a.size() == 5);
+    REQUIRE(of_a[0].kind == vhdl::library_unit_kind::architecture);
+    REQUIRE(of_a[0].identifier2 == "top");
+
+    auto on_child = lib->dependents("child");
+    REQUIRE(on_child.size() == 2);
+    REQUIRE(on_child[0].identifier == "a");
+    REQUIRE(on_child[0].name2 == "rtl");
+
+    lib->forget_dependencies("top.vhd");
+    REQUIRE(lib->dependencies().empty());
+
+    // so are the units, which a file changing on disk replaces
+    for (auto& unit : units)
+        REQUIRE(lib->put(unit));
+    lib->put({vhdl::library_unit_kind::entity, 1, 1, "child", std::nullopt,
+              "child.vhd", 0});
+    REQUIRE(lib->in_file("top.vhd").size() == 3);
+
+    lib->forget_units("top.vhd");
+    REQUIRE(lib->in_file("top.vhd").empty());
+    REQUIRE(lib->all().size() == 1);
+}
+
+TEST_CASE("dependencies are stored whatever their names hold", "[library]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    manager->initialise({"lib"});
+    auto lib = manager->get("lib");
+
+    vhdl::dependency d;
+    d.filename = "it's here.vhd";
+    d.kind = vhdl::library_unit_kind::entity;
+    d.identifier = "top";
+    d.on = vhdl::dependency_kind::use;
+    d.library = "wo'rk";
+    d.name = "p'";
+    REQUIRE(lib->put(d));
+
+    auto of_top = lib->dependencies("top");
+    REQUIRE(of_top.size() == 1);
+    REQUIRE(of_top[0].filename == "it's here.vhd");
+    REQUIRE(of_top[0].library == "wo'rk");
+    REQUIRE_FALSE(of_top[0].identifier2);
+    REQUIRE(lib->dependents("p'").size() == 1);
+
+    lib->forget_dependencies("it's here.vhd");
+    REQUIRE(lib->dependencies().empty());
+}
+
+TEST_CASE("the units of a file are replaced whatever its name holds",
+          "[library]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    manager->initialise({"lib"});
+    auto lib = manager->get("lib");
+
+    using kind = vhdl::library_unit_kind;
+    REQUIRE(lib->put({kind::entity, 1, 1, "top", std::nullopt, "it's here.vhd", 0}));
+    REQUIRE(lib->put({kind::architecture, 3, 1, "rtl", "top", "it's here.vhd", 0}));
+    REQUIRE(lib->put({kind::entity, 1, 1, "child", std::nullopt, "child.vhd", 0}));
+
+    REQUIRE(lib->in_file("it's here.vhd").size() == 2);
+    REQUIRE(lib->all(0, "top").size() == 2);
+
+    // a unit put again replaces the one stored
+    REQUIRE(lib->put({kind::entity, 2, 1, "top", std::nullopt, "it's here.vhd", 0}));
+    REQUIRE(lib->all(0, "top").size() == 2);
+    REQUIRE(std::get<1>(lib->get("top")) == 2);
+
+    // what the watcher does with a file gone
+    lib->forget_units("it's here.vhd");
+    REQUIRE(lib->in_file("it's here.vhd").empty());
+    REQUIRE(lib->all().size() == 1);
+}
+
+TEST_CASE("updating the libraries keeps what the kept ones hold", "[library]")
+{
+    auto manager = std::make_shared<vhdl::library_manager>(std::nullopt);
+    manager->initialise({"a", "b"});
+
+    using kind = vhdl::library_unit_kind;
+    auto a = manager->get("a");
+    auto b = manager->get("b");
+    a->put({kind::entity, 1, 1, "e", std::nullopt, "e.vhd", 0});
+    b->put({kind::entity, 1, 1, "f", std::nullopt, "f.vhd", 0});
+
+    manager->update({"a", "c"});
+
+    auto names = manager->list();
+    std::sort(names.begin(), names.end());
+    REQUIRE(names == std::vector<std::string>{"a", "c"});
+
+    REQUIRE(manager->get("a") == a);
+    REQUIRE(a->all().size() == 1);
+    REQUIRE(manager->get("c")->is_known());
+    REQUIRE(manager->get("c")->all().empty());
+
+    // what held the library dropped can tell
+    REQUIRE_FALSE(b->is_valid());
+}
@@ -3,10 +3,17 @@
 #include <list>
 #include <variant>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
 #include <string>
 
+#include "common/diagnostics.h"
+#include "common/histogram.h"
 #include "common/location.h"
 #include "common/position.h"
+#include "common/text_document.h"
+#include "common/trace.h"
 
 SCENARIO("vectors can be sized and resized", "[vector]")
 {
@@ -239,4 +246,124 @@ TEST_CASE("location contains works", "[location][position]")
     }
 }
 
+TEST_CASE("text documents apply incremental changes", "[text_document]")
+{
+    common::text_document d("entity e is\r\nend entity;\n", 1);
+    REQUIRE(d.lines() == 3);
+
+    // insert within a line
+    REQUIRE(d.replace({0, 7}, {0, 8}, "foo", 2));
+    REQUIRE(d.text() == "entity foo is\r\nend entity;\n");
+    REQUIRE(d.offset({1, 0}) == 15);
+
+    // a change spanning lines, adding a line
+    REQUIRE(d.replace({0, 11}, {1, 3}, "is\n  port (a: in bit);\nend", 3));
+    REQUIRE(d.text() == "entity foo is\n  port (a: in bit);\nend entity;\n");
+    REQUIRE(d.lines() == 4);
+    REQUIRE(d.offset({2, 0}) == 34);
+    REQUIRE(d.version() == 3);
+
+    // a column past the end of a line stops before its end of line
+    REQUIRE(d.offset({0, 100}) == 13);
+    REQUIRE(d.offset({100, 0}) == d.text().size());
+
+    // removing lines
+    REQUIRE(d.replace({0, 13}, {2, 0}, "", 4));
+    REQUIRE(d.text() == "entity foo isend entity;\n");
+    REQUIRE(d.lines() == 2);
+    REQUIRE(d.offset({1, 0}) == d.text().size());
+
+    // a reversed range is refused
+    REQUIRE_FALSE(d.replace({0, 5}, {0, 2}, "x", 5));
+    REQUIRE(d.version() == 4);
+
+    // columns count utf-16 code units
+    d.replace("-- \xc3\xa9\xf0\x9f\x98\x80x\n", 6);
+    REQUIRE(d.offset({0, 4}) == 5);
+    REQUIRE(d.offset({0, 6}) == 9);
+    REQUIRE(d.lines() == 2);
+}
+
+TEST_CASE("histograms bucket durations by powers of two", "[histogram]")
+{
+    using namespace std::chrono_literals;
+
+    common::histogram h;
+    REQUIRE(h.get().count == 0);
+    REQUIRE(h.get().percentile(0.5) == 0);
+
+    h.record(500ns);
+    for (int i = 0; i < 8; i++)
+        h.record(3ms);
+    h.record(100ms);
+
+    auto s = h.get();
+    REQUIRE(s.count == 10);
+    REQUIRE(s.buckets[0] == 1);
+    REQUIRE(s.buckets[12] == 8); // 2048us up to 4096us
+    REQUIRE(s.max_ms == 100);
+    REQUIRE(s.total_ms == Approx(124));
+
+    REQUIRE(s.percentile(0.05) == common::histogram::upper_bound_ms(0));
+    REQUIRE(s.percentile(0.5) == Approx(4.096));
+    REQUIRE(s.percentile(1.0) == 100);
+}
+
+TEST_CASE("diagnostics are fingerprinted before being formatted",
+          "[diagnostics]")
+{
+    auto make = [](int line, std::string name) {
+        std::vector<common::diagnostic> diags;
+        diags.emplace_back("`{}` not found", common::location("f.vhd", line, 3));
+        diags.back() << name;
+        diags.emplace_back("expected {} ports", common::location("f.vhd", 9, 1));
+        diags.back() << 2;
+        return diags;
+    };
+
+    auto same = common::fingerprint(make(4, "clk"));
+    REQUIRE(common::fingerprint(make(4, "clk")) == same);
+    REQUIRE(common::fingerprint(make(5, "clk")) != same);
+    REQUIRE(common::fingerprint(make(4, "rst")) != same);
+    REQUIRE(common::fingerprint({}) != same);
+
+    auto reversed = make(4, "clk");
+    std::swap(reversed[0], reversed[1]);
+    REQUIRE(common::fingerprint(reversed) != same);
+
+    auto with_note = make(4, "clk");
+    with_note[0].add_note("declared here", common::location("f.vhd", 1, 1));
+    REQUIRE(common::fingerprint(with_note) != same);
+}
+
+TEST_CASE("trace spans are written as chrome trace events", "[trace]")
+{
+    auto path = std::filesystem::temp_directory_path() / "vhdlstuff_trace.json";
+
+    { TRACE_SPAN("before"); }
 
+    REQUIRE(common::trace::start(path.string()));
+    {
+        TRACE_SPAN("parse", "a \"quoted\" file.vhd");
+        TRACE_COMPLETE("queued", "", std::chrono::steady_clock::now(),
+                       std::chrono::steady_clock::now());
+    }
+    common::trace::stop();
+
+    { TRACE_SPAN("after"); }
+
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    auto trace = content.str();
+    std::filesystem::remove(path);
+
+    REQUIRE(trace.front() == '[');
+    REQUIRE(trace.find("]") == trace.size() - 2);
+    REQUIRE(trace.find("\"thread_name\"") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"parse\"") != std::string::npos);
+    REQUIRE(trace.find("a \\\"quoted\\\" file.vhd") != std::string::npos);
+    REQUIRE(trace.find("\"name\":\"queued\"") != std::string::npos);
+    REQUIRE(trace.find("before") == std::string::npos);
+    REQUIRE(trace.find("after") == std::string::npos);
+}
@@ -336,6 +336,35 @@ TEST_CASE("serdes json", "[serialize]")
     REQUIRE(first.params == second.params);
 }
 
+struct struct_with_views
+{
+    std::string_view text;
+    std::vector<std::string_view> array;
+};
+
+SERIALIZABLE_STRUCT_BEGIN(struct_with_views)
+SERIALIZABLE_STRUCT_MEMBER(text)
+SERIALIZABLE_STRUCT_MEMBER(array)
+SERIALIZABLE_STRUCT_END()
+
+TEST_CASE("read string views from a document parsed in situ", "[serialize]")
+{
+    std::string message = "{\"params\":{\"text\":\"hello\",\"array\":[\"a\",\"b\"]}}";
+
+    rapidjson::Document reader;
+    reader.ParseInsitu(message.data());
+
+    auto views = serialize::from_json<struct_with_views>(reader["params"]);
+
+    REQUIRE(views.text == "hello");
+    REQUIRE(views.array.size() == 2);
+    REQUIRE(views.array[1] == "b");
+
+    // nothing was copied, the views point into the message
+    REQUIRE(views.text.data() >= message.data());
+    REQUIRE(views.text.data() < message.data() + message.size());
+}
+
 //
 // Can this be done:
 //
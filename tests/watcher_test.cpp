@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "things/watcher.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+
+namespace
+{
+
+// collects what the watcher hands over, from the thread of the watcher
+struct collected
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    things::watcher::changes changes;
+
+    void add(things::watcher::changes more)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        changes.insert(changes.end(), more.begin(), more.end());
+        cv.notify_all();
+    }
+
+    // wait for a change of the file, and take it
+    std::optional<things::watcher::change> take(const std::string& path)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        std::optional<things::watcher::change> found;
+        cv.wait_for(lock, std::chrono::seconds(5), [&]() {
+            for (auto& [p, c] : changes)
+                if (p == path)
+                    found = c;
+            return found.has_value();
+        });
+        changes.clear();
+        return found;
+    }
+};
+
+}
+
+TEST_CASE("the watcher reports files written and removed", "[watcher]")
+{
+    auto folder = std::filesystem::temp_directory_path() / "vhdlstuff_watcher_test";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder / "sub");
+    auto file = (folder / "sub" / "top's.vhd").string();
+
+    collected seen;
+    things::watcher watcher([&seen](things::watcher::changes c) {
+        seen.add(std::move(c));
+    });
+
+#ifdef __linux__
+    REQUIRE(watcher.start({{folder.string(), true}}));
+
+    {
+        std::ofstream out(file);
+        out << "entity top is end entity;\n";
+    }
+    REQUIRE(seen.take(file) == things::watcher::change::written);
+
+    std::filesystem::remove(file);
+    REQUIRE(seen.take(file) == things::watcher::change::removed);
+
+    watcher.stop();
+    REQUIRE_FALSE(watcher.is_running());
+#else
+    REQUIRE_FALSE(watcher.start({{folder.string(), true}}));
+#endif
+
+    std::filesystem::remove_all(folder);
+}